@@ -1,64 +1,78 @@
 #include "Actor.h"
 #include "StudentWorld.h"
 #include "GameConstants.h"
+#include "Systems.h"
 
 #include <algorithm>
 
 // Students:  Add code to this file, Actor.h, StudentWorld.h, and StudentWorld.cpp
 
 bool checkIndex(int xx, int yy); // checks if index is valid based on grid size
-bool sampleChance(); // returns true randomly 1/3 of the time
+bool sampleChance(Random& rng); // returns true randomly 1/3 of the time
 
 Actor::Actor(StudentWorld* sw, int imageID, int startX, int startY, int startDirection)
-: GraphObject(imageID, startX, startY, startDirection), m_isAlive(true), m_world(sw), 
-m_isPassable(true), m_isClimbable(false), m_isBlastable(false), m_isBurnable(false), m_nTicks(0) {
-
+: GraphObject(sw->graphObjects(), imageID, startX, startY, startDirection), m_world(sw), m_handle(INVALID_SLOT_HANDLE), m_pool(nullptr) {
+	m_handle = sw->registerActor(this); // creates this actor's components
 }
 
 Actor::~Actor() {
 	// do nothing
 }
 
-bool Actor::passable() const {
-	return m_isPassable;
-}
-
-bool Actor::climbable() const {
-	return m_isClimbable;
-}
-
 bool Actor::blastable() const {
-	return m_isBlastable;
+	return (m_world->components().flags[m_handle.index] & CAP_BLASTABLE) != 0;
 }
 
 bool Actor::alive() const{
-	return m_isAlive;
+	return (m_world->components().flags[m_handle.index] & CAP_ALIVE) != 0; // an actor's handle stays valid until it is reaped
 }
 
 bool Actor::burnable() const {
-	return m_isBurnable;
+	return (m_world->components().flags[m_handle.index] & CAP_BURNABLE) != 0;
 }
 
 void Actor::kill() {
-	m_isAlive = false;
+	m_world->components().flags[m_handle.index] &= ~CAP_ALIVE;
+}
+
+ActorHandle Actor::handle() const {
+	return m_handle;
+}
+
+void Actor::setDirection(int d) {
+	m_world->setEntityDirection(m_handle, d);
+}
+
+ActorPoolBase* Actor::pool() const {
+	return m_pool;
+}
+
+void Actor::setPool(ActorPoolBase* pool) {
+	m_pool = pool;
+}
+
+void Actor::reinit(int startX, int startY, int startDirection) {
+	reset(startX, startY, startDirection);
+	m_handle = m_world->registerActor(this); // fresh components under a new handle
 }
 
 bool Actor::tryMoveTo(int xx, int yy) {
 	// returns true if success
-	if (m_world->checkPassable(xx, yy)) {
-		moveTo(xx, yy);
-		return true;
-	}
-	return false;
+	return m_world->moveEntity(m_handle, xx, yy);
 }
 
 void Actor::incTicks() {
-	m_nTicks++;
-	m_nTicks %= MAX_MOD_FACTOR; // to ensure m_nTicks does not exceed integer limits
+	int& nTicks = m_world->components().ticks[m_handle.index];
+	nTicks++;
+	nTicks %= MAX_MOD_FACTOR; // to ensure the tick count does not exceed integer limits
 }
 
 bool Actor::checkModMTick(int m) {
-	return m_nTicks % m == 0;
+	return m_world->components().ticks[m_handle.index] % m == 0;
+}
+
+int Actor::ticksUntilModMTick(int m) const {
+	return m - m_world->components().ticks[m_handle.index] % m;
 }
 
 
@@ -70,30 +84,32 @@ void Actor::doSomething() {
 	// do nothing by default
 }
 
+void Actor::onPlayerContact(int /* contactType */) {
+	// do nothing by default
+}
+
 bool Actor::tryMoveInDirection() {
 	if (getDirection() == left) return tryMoveTo(getX() - 1, getY());
 	else return tryMoveTo(getX() + 1, getY()); // direction == right
 }
 
-void Actor::setPassable(bool b) {
-	m_isPassable = b;
-}
-
-void Actor::setClimbable(bool b) {
-	m_isClimbable = b;
-}
-
 void Actor::setBlastable(bool b) {
-	m_isBlastable = b;
+	if (b) addCapabilities(CAP_BLASTABLE);
+	else m_world->components().flags[m_handle.index] &= ~CAP_BLASTABLE;
 }
 
 void Actor::setBurnable(bool b) {
-	m_isBurnable = b;
+	if (b) addCapabilities(CAP_BURNABLE);
+	else m_world->components().flags[m_handle.index] &= ~CAP_BURNABLE;
+}
+
+void Actor::addCapabilities(int caps) {
+	m_world->components().flags[m_handle.index] |= caps;
 }
 
 Player::Player(StudentWorld* sw, int startX, int startY, int startDirection) 
 : Actor(sw, IID_PLAYER, startX, startY, startDirection), m_nBurps(0), m_nJumpTicks(0), m_freezeCounter(0) {
-
+	addCapabilities(CAP_HELD_BY_LADDERS);
 }
 
 void Player::doSomething() {
@@ -119,8 +135,8 @@ void Player::doSomething() {
 		}
 		
 	}
-	else if (!(getWorld()->checkClimbable(getX(), getY())) && !(getWorld()->checkClimbable(getX(), getY() - 1)) && (getWorld()->checkPassable(getX(), getY() - 1))) {
-		tryMoveTo(getX(), getY() - 1); // fall under gravity if no ladder or floor
+	else if (gravitySystem(*getWorld(), handle())) {
+		// fell under gravity since there is no ladder or floor
 	}
 	else if (m_freezeCounter > 0) {
 		// frozen
@@ -128,7 +144,7 @@ void Player::doSomething() {
 	}
 	else { // read user input
 		int ch;
-		if (getWorld()->getKey(ch)) {
+		if (getWorld()->playerKey(ch)) {
 			switch (ch) {
 			case KEY_PRESS_LEFT: // move left
 				if (getDirection() == right) setDirection(left);
@@ -156,7 +172,7 @@ void Player::doSomething() {
 					else x++;
 
 					if (checkIndex(x, y)) {
-						getWorld()->addActor(new Burp(getWorld(), x, y, getDirection()));
+						getWorld()->createBurp(x, y, getDirection());
 						m_nBurps--;
 					}
 				}
@@ -183,18 +199,16 @@ int Player::getBurps() const {
 	return m_nBurps;
 }
 
-void Player::freeze(){
-	m_freezeCounter += NUM_FREEZE_TICKS;
+int Player::getJumpTicks() const {
+	return m_nJumpTicks;
 }
 
-Floor::Floor(StudentWorld* sw, int startX, int startY)
-: Actor(sw, IID_FLOOR, startX, startY) {
-	setPassable(false);
+int Player::getFreezeTicks() const {
+	return m_freezeCounter;
 }
 
-Ladder::Ladder(StudentWorld* sw, int startX, int startY)
-	: Actor(sw, IID_LADDER, startX, startY) {
-	setClimbable(true);
+void Player::freeze(){
+	m_freezeCounter += NUM_FREEZE_TICKS;
 }
 
 Burp::Burp(StudentWorld* sw, int startX, int startY, int startDirection)
@@ -202,6 +216,12 @@ Burp::Burp(StudentWorld* sw, int startX, int startY, int startDirection)
 	sw->playSound(SOUND_BURP);
 }
 
+void Burp::reinit(int startX, int startY, int startDirection) {
+	Actor::reinit(startX, startY, startDirection);
+	m_lifetime = 5;
+	getWorld()->playSound(SOUND_BURP);
+}
+
 void Burp::doSomething() {
 	if (m_lifetime > 0) m_lifetime--;
 	if (m_lifetime == 0) {
@@ -218,146 +238,120 @@ Enemy::Enemy(StudentWorld* sw, int imageID, int startX, int startY, int startDir
 
 Enemy::~Enemy() {}
 
-void Enemy::doSomething() {
-	if (getWorld()->isPlayerLocation(getX(), getY())) getWorld()->attackPlayer();
-}
-
-bool Enemy::checkCliffInDirection() const {
-	if (getDirection() == left) return (getWorld()->checkPassable(getX() - 1, getY() - 1) && !(getWorld()->checkClimbable(getX() - 1, getY() - 1)));
-	else return (getWorld()->checkPassable(getX() + 1, getY() - 1) && !(getWorld()->checkClimbable(getX() + 1, getY() - 1)));
-}
-
 void Enemy::toggleDirection() {
 	if (getDirection() == left) setDirection(right);
 	else setDirection(left);
 }
 
-void Enemy::lateralMove() {
-	if (checkCliffInDirection() || !tryMoveInDirection()) toggleDirection(); // move in original direction, unless blocked by cliff or wall, then reverse direction
-}
-
 Bonfire::Bonfire(StudentWorld* sw, int startX, int startY) 
 	: Enemy(sw, IID_BONFIRE, startX, startY) {
-
+	addCapabilities(CAP_HARMFUL);
 }
 
 void Bonfire::doSomething() {
 	increaseAnimationNumber();
 	getWorld()->attackEnemy(getX(), getY(), true); // set to true to attack burnable items (i.e. barrel)
-	Enemy::doSomething(); // kill player if same square
 }
 
 Fireball::Fireball(StudentWorld* sw, int startX, int startY)
-	: Enemy(sw, IID_FIREBALL, startX, startY), m_climbingState(STATE_NOT_CLIMBING) {
-	if (randInt(0, 1) == 0) setDirection(left);
+	: Enemy(sw, IID_FIREBALL, startX, startY) {
+	addCapabilities(CAP_HARMFUL | CAP_AVOIDS_CLIFFS);
+	if (sw->random().intIn(0, 1) == 0) setDirection(left);
 	else setDirection(right);
 }
 
 void Fireball::doSomething() {
 	incTicks();
 	if (!alive()) return;
-	Enemy::doSomething(); // kill player if same square
-	if (!(getWorld()->checkPlayerAlive())) return;
 	if (!checkModMTick(TICK_FACTOR)) return;
-	bool hasMoved = false;
-	if (m_climbingState != STATE_CLIMBING_DOWN && getWorld()->checkClimbable(getX(), getY()) && getWorld()->checkPassable(getX(), getY() + 1)) {
-		if (m_climbingState == STATE_CLIMBING_UP || sampleChance()) { 
-			// climb up ladder, by following original motion or randomly deciding if originally not climbing
-			m_climbingState = STATE_CLIMBING_UP;
-			tryMoveTo(getX(), getY() + 1);
-			hasMoved = true;
-		}
-	}
-	else if (m_climbingState != STATE_CLIMBING_UP && getWorld()->checkClimbable(getX(), getY() - 1)){
-		if (m_climbingState == STATE_CLIMBING_DOWN || sampleChance()) {
-			// climb down ladder, by following original motion or randomly deciding if originally not climbing
-			m_climbingState = STATE_CLIMBING_DOWN;
-			tryMoveTo(getX(), getY() - 1);
-			hasMoved = true;
-		}
-	}
-	if (!hasMoved) {
-		// One action at a time. If action executed previously, we skip the body of the if statement
-		if ((m_climbingState == STATE_CLIMBING_UP && (!(getWorld()->checkPassable(getX(), getY() + 1))
-			|| !(getWorld()->checkClimbable(getX(), getY())))) ||
-			(m_climbingState == STATE_CLIMBING_DOWN && (!(getWorld()->checkPassable(getX(), getY() - 1)) ||
-				!(getWorld()->checkClimbable(getX(), getY() - 1))))) {
-			m_climbingState = STATE_NOT_CLIMBING;
-		}
-		lateralMove(); // move left and right
-	}
-	Enemy::doSomething(); // kill player if same square
+	// One action at a time: climb a ladder, otherwise move left and right
+	if (!climbSystem(*getWorld(), handle())) patrolSystem(*getWorld(), handle());
+}
+
+int Fireball::nextWakeup() const {
+	return ticksUntilModMTick(TICK_FACTOR);
 }
 
 void Fireball::kill() {
 	Actor::kill();
-	if (sampleChance()) getWorld()->dropGarlic(getX(), getY());
+	if (sampleChance(getWorld()->random())) getWorld()->dropGarlic(getX(), getY());
 }
 
 Koopa::Koopa(StudentWorld* sw, int startX, int startY)
-	: Enemy(sw, IID_KOOPA, startX, startY), m_freezeCooldown(0){
-	if (randInt(0, 1) == 0) setDirection(left);
+	: Enemy(sw, IID_KOOPA, startX, startY) {
+	addCapabilities(CAP_FREEZES | CAP_AVOIDS_CLIFFS);
+	if (sw->random().intIn(0, 1) == 0) setDirection(left);
 	else setDirection(right);
 }
 
 void Koopa::doSomething() {
 	incTicks();
 	if (!alive()) return;
-	if (tryFreezePlayer()) return;
-	if (m_freezeCooldown > 0) m_freezeCooldown--;
-	if (checkModMTick(TICK_FACTOR)) lateralMove();
-	if (tryFreezePlayer()) return;
+	if (checkModMTick(TICK_FACTOR)) patrolSystem(*getWorld(), handle()); // the freeze cooldown is a deadline, so it needs no counting down here
 }
 
-bool Koopa::tryFreezePlayer() {
-	if (m_freezeCooldown == 0 && getWorld()->isPlayerLocation(getX(), getY())) {
-		getWorld()->freezePlayer();
-		m_freezeCooldown = FREEZE_COOLDOWN_TICKS;
-		return true;
-	}
-	return false;
+int Koopa::nextWakeup() const {
+	return ticksUntilModMTick(TICK_FACTOR);
 }
 
 void Koopa::kill() {
 	Actor::kill();
-	if (sampleChance()) getWorld()->dropExtraLife(getX(), getY());
+	if (sampleChance(getWorld()->random())) getWorld()->dropExtraLife(getX(), getY());
+}
+
+Hunter::Hunter(StudentWorld* sw, int startX, int startY)
+	: Enemy(sw, IID_HUNTER, startX, startY, right) {
+	addCapabilities(CAP_HARMFUL | CAP_AVOIDS_CLIFFS | CAP_HELD_BY_LADDERS);
+}
+
+void Hunter::doSomething() {
+	incTicks();
+	if (!alive()) return;
+	if (gravitySystem(*getWorld(), handle())) return; // hunters fall like the player, so they can drop off ledges to reach it
+	if (!checkModMTick(TICK_FACTOR)) return;
+	if (!chaseSystem(*getWorld(), handle())) patrolSystem(*getWorld(), handle()); // no way to reach the player, so patrol instead
+}
+
+int Hunter::nextWakeup() const {
+	if (unsupported(*getWorld(), handle())) return 1; // falls every tick
+	return ticksUntilModMTick(TICK_FACTOR); // terrain never changes, so a standing hunter stays put until its next step
 }
 
 Barrel::Barrel(StudentWorld* sw, int startX, int startY, int startDirection)
 	: Enemy(sw, IID_BARREL, startX, startY, startDirection) {
-	setBurnable(true);
+	addCapabilities(CAP_BURNABLE | CAP_HARMFUL);
+}
+
+void Barrel::reinit(int startX, int startY, int startDirection) {
+	Actor::reinit(startX, startY, startDirection);
+	addCapabilities(CAP_BLASTABLE | CAP_BURNABLE | CAP_HARMFUL);
 }
 
 void Barrel::doSomething() {
 	incTicks();
 	if (!alive()) return;
-	Enemy::doSomething(); // kill player if same square
-	if (!(getWorld()->checkPlayerAlive())) return;
 
-	if (getWorld()->checkPassable(getX(), getY() - 1)) {
-		tryMoveTo(getX(), getY() - 1); // fall under gravity
+	if (gravitySystem(*getWorld(), handle())) { // fall under gravity
 		if (!(getWorld()->checkPassable(getX(), getY() - 1))) toggleDirection(); // reverse direction upon landing on the ground
 	}
 
-	if (checkModMTick(TICK_FACTOR)) { // once every 10 ticks
-		if (!tryMoveInDirection()) toggleDirection(); // change direction if encounter wall. Continue moving in same direction if encounter cliff.
-	}
-	Enemy::doSomething(); // kill player if same square
+	if (checkModMTick(TICK_FACTOR)) patrolSystem(*getWorld(), handle()); // once every 10 ticks. Barrels turn at walls but roll off cliffs
 }
 
 Goodie::Goodie(StudentWorld* sw, int imageID, int startX, int startY)
 	: Actor(sw, imageID, startX, startY), m_extraPoints(0) {
-
+	addCapabilities(CAP_PICKUP);
 }
 
 Goodie::~Goodie() {}
 
-void Goodie::doSomething() {
-	if (alive() && getWorld()->isPlayerLocation(getX(), getY())) {
-		getWorld()->playSound(SOUND_GOT_GOODIE);
-		getWorld()->increaseScore(m_extraPoints);
-		kill(); // Goodie disappears
-	}
+void Goodie::reinit(int startX, int startY) {
+	Actor::reinit(startX, startY);
+	addCapabilities(CAP_PICKUP);
+}
+
+void Goodie::onPlayerContact(int /* contactType */) {
+	pickupSystem(*getWorld(), handle(), m_extraPoints); // sound, score and destruction
 }
 
 void Goodie::setExtraPoints(int p) {
@@ -373,10 +367,8 @@ ExtraLifeGoodie::ExtraLifeGoodie(StudentWorld* sw, int startX, int startY)
 	setExtraPoints(EXTRA_LIFE_POINTS);
 }
 
-void ExtraLifeGoodie::doSomething() {
-	if (!alive()) return;
-	if (getWorld()->isPlayerLocation(getX(), getY())) getWorld()->incLives();
-	Goodie::doSomething();
+void ExtraLifeGoodie::onPlayerContact(int /* contactType */) {
+	if (pickupSystem(*getWorld(), handle(), extraPoints())) getWorld()->incLives();
 }
 
 GarlicGoodie::GarlicGoodie(StudentWorld* sw, int startX, int startY)
@@ -384,22 +376,19 @@ GarlicGoodie::GarlicGoodie(StudentWorld* sw, int startX, int startY)
 	setExtraPoints(GARLIC_POINTS);
 }
 
-void GarlicGoodie::doSomething() {
-	if (!alive()) return;
-	if (getWorld()->isPlayerLocation(getX(), getY())) getWorld()->increaseBurps(NUM_EXTRA_BURPS);
-	Goodie::doSomething();
+void GarlicGoodie::onPlayerContact(int /* contactType */) {
+	if (pickupSystem(*getWorld(), handle(), extraPoints())) getWorld()->increaseBurps(NUM_EXTRA_BURPS);
 }
 
 Kong::Kong(StudentWorld* sw, int startX, int startY, int startDirection) 
 	: Actor(sw, IID_KONG, startX, startY, startDirection), m_flee(false) {
-
+	addCapabilities(CAP_FLEES);
 }
 
 void Kong::doSomething() {
 	incTicks();
 	if (!alive()) return;
-	increaseAnimationNumber();
-	if (getWorld()->closeToPlayer(getX(), getY())) m_flee = true;
+	increaseAnimationNumber(); // m_flee is set by the contact phase once the player comes close
 
 	int N = std::max(200 - 50 * getWorld()->getLevel(), 50); // N
 
@@ -409,7 +398,7 @@ void Kong::doSomething() {
 		if (getDirection() == left) x--;
 		else x++;
 
-		if (checkIndex(x, y)) getWorld()->addActor(new Barrel(getWorld(), x, y, getDirection()));
+		if (checkIndex(x, y) && getWorld()->barrelsInPlay() < MAX_BARRELS_IN_PLAY) getWorld()->createBarrel(x, y, getDirection());
 	}
 
 	if (checkModMTick(KONG_TICK_FACTOR) && m_flee) {
@@ -422,9 +411,12 @@ void Kong::doSomething() {
 	}
 }
 
+void Kong::onPlayerContact(int contactType) {
+	if (contactType == CONTACT_FLEE) m_flee = true;
+}
+
 // ===== Helper Functions =====
 
-bool sampleChance() {
-	if (randInt(0, SAMPLE_DENOMINATOR - 1) == 0) return true;
-	return false;
+bool sampleChance(Random& rng) {
+	return rng.oneIn(SAMPLE_DENOMINATOR);
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "SlotMap.h"
+#include "Components.h"
 
 // Students:  Add code to this file, Actor.cpp, StudentWorld.h, and StudentWorld.cpp
 
@@ -23,45 +25,50 @@ const int STATE_CLIMBING_UP = 1;
 const int STATE_CLIMBING_DOWN = 2;
 
 class StudentWorld;
+class ActorPoolBase;
+
+typedef SlotHandle ActorHandle; // generational reference to an Actor owned by StudentWorld. Safe to hold across ticks
 
 class Actor : public GraphObject { // class should never be instantiated -> base class for all actors
 public:
 	Actor(StudentWorld* sw, int imageID, int startX, int startY, int startDirection = none);
 	virtual ~Actor() = 0; // pure virtual destructor to make the class an Abstract Base Class
 	virtual void doSomething(); // does nothing, usually overwritten
-	bool alive() const; // getter for m_isAlive
-	bool blastable() const; // getter for m_isBlastable
-	bool burnable() const; // getter for m_isBurnable
-	bool passable() const; // getter for m_isPassable
-	bool climbable() const; // getter for m_isClimbable
+	virtual void onPlayerContact(int contactType); // does nothing. Overwritten by actors that react to a CONTACT_PICKUP or CONTACT_FLEE event
+	bool alive() const; // checks CAP_ALIVE in this actor's components
+	bool blastable() const; // checks CAP_BLASTABLE in this actor's components
+	bool burnable() const; // checks CAP_BURNABLE in this actor's components
 	virtual void kill(); // Actor can either kill itself or be killed. This function can be overwritten for custom kill() methods
+	ActorHandle handle() const; // getter for m_handle, which is also this actor's entity in StudentWorld's components
+	void setDirection(int d); // hides GraphObject::setDirection() so the direction component stays in sync
+	ActorPoolBase* pool() const; // getter for m_pool
+	void setPool(ActorPoolBase* pool); // setter for m_pool. Controlled by ActorPool
+	void reinit(int startX, int startY, int startDirection = none); // brings a recycled actor back to life as if newly constructed
 protected:
 	StudentWorld* getWorld() const; // getter for m_world
-	void setPassable(bool b); // setter for m_isPassable
-	void setClimbable(bool b); // setter for m_isClimbable
-	void setBlastable(bool b); // setter for m_isBlastable
-	void setBurnable(bool b); // setter for m_isBurnable
+	void setBlastable(bool b); // sets or clears CAP_BLASTABLE
+	void setBurnable(bool b); // sets or clears CAP_BURNABLE
+	void addCapabilities(int caps); // sets the given CAP_* flags
 	void incTicks(); // increments ticks withing doSomething(), for functions which require tick tracking
-	bool checkModMTick(int m); // checks the condition m_nTicks mod m == 0, m is determined based on Actor type
+	bool checkModMTick(int m); // checks the condition ticks mod m == 0, m is determined based on Actor type
+	int ticksUntilModMTick(int m) const; // ticks until checkModMTick(m) next holds, from 1 to m
 	bool tryMoveTo(int xx, int yy); // safe function to move to (xx, yy). If cannot move due to wall or out of bounds, returns false
 	bool tryMoveInDirection(); // safe function to move in current direction by one step. If cannot move due to wall or out of bounds, returns false
 private:
 	StudentWorld* m_world; // reference to StudentWorld object which manages all Actors
-	bool m_isAlive; // flag to check whether actor is alive
-	bool m_isPassable; // flag to check whether player can pass through object, default true
-	bool m_isClimbable; // flag to check whether player can climb object (i.e. ladder), default false
-	bool m_isBlastable; // flag to check whether object can be destroyed by burp
-	bool m_isBurnable; // flag to check whether object can be destroyed by bonfire
-	int m_nTicks; // tracks the number of ticks (i.e. calls to doSomething()) since Actor is created
+	ActorHandle m_handle; // this actor's handle in StudentWorld, assigned when it is constructed or recycled. Its state (alive, ticks, ...) lives in the component row m_handle.index
+	ActorPoolBase* m_pool; // pool that recycles this actor once it dies, or nullptr if it is not pooled
 };
 
-class Player : public Actor { // movable player controlled by keyboard
+class Player final : public Actor { // movable player controlled by keyboard
 public:
 	Player(StudentWorld* sw, int startX, int startY, int startDirection);
 	virtual void doSomething(); // player controls
 	virtual void kill(); // player dies
 	void increaseBurps(int k); // increases number of burps. Controlled by StudentWorld
 	int getBurps() const; // getter for number of burps
+	int getJumpTicks() const; // substeps left in the current jump, 0 when not jumping
+	int getFreezeTicks() const; // ticks left frozen, 0 when not frozen
 	void freeze(); // freezes the player for NUM_FREEZE_TICKS
 private:
 	int m_nBurps; // Current number of burps available. Starts at 0.
@@ -69,20 +76,11 @@ private:
 	int m_freezeCounter; // Number of ticks left to be frozen
 };
 
-class Floor : public Actor { // Actor has no behavior, inherits doSomething() from Actor
-public:
-	Floor(StudentWorld* sw, int startX, int startY); // m_isPassable is set to false
-};
-
-class Ladder : public Actor { // Actor has no behavior, inherits doSomething() from Actor
-public:
-	Ladder(StudentWorld* sw, int startX, int startY); // m_is_Climbable is set to true
-};
-
-class Burp : public Actor { // Burp created by player dynamically
+class Burp final : public Actor { // Burp created by player dynamically
 public:
 	Burp(StudentWorld* sw, int startX, int startY, int startDirection);
 	virtual void doSomething(); // track lifetime and attack player if on same square
+	void reinit(int startX, int startY, int startDirection); // resets lifetime in addition to Actor::reinit()
 private:
 	int m_lifetime; // initially 5, decrements with each doSomething()
 };
@@ -91,48 +89,51 @@ class Enemy : public Actor {
 public:
 	Enemy(StudentWorld* sw, int imageID, int startX, int startY, int startDirection = none);
 	virtual ~Enemy() = 0; // pure virtual destructor to make the class an Abstract Base Class
-	virtual void doSomething(); // Attacks player if same square. This is called by most child functions.
-	bool checkCliffInDirection() const; // Check if in that direction, if player takes one more step, if the player will fall under gravity
 	void toggleDirection(); // toggles between left and right
-	void lateralMove(); // moves left and right along a path with endpoints of either walls or cliffs
 };
 
-class Bonfire : public Enemy {
+class Bonfire final : public Enemy {
 public:
 	Bonfire(StudentWorld* sw, int startX, int startY);
-	virtual void doSomething(); // attack player or barrel if on same square, as well as manage animations
+	virtual void doSomething(); // attack barrels on the same square, as well as manage animations
 };
 
-class Fireball : public Enemy {
+class Fireball final : public Enemy {
 public:
 	Fireball(StudentWorld* sw, int startX, int startY);
-	virtual void doSomething(); // manages movement of fireball, attacks player if on same square
+	virtual void doSomething(); // manages movement of fireball
+	int nextWakeup() const; // ticks until doSomething() next has work to do. Fireballs run from a timer wheel
 	virtual void kill(); // in addition to inherited kill(), it also drops garlic goodie with probability 1/3
-private:
-	int m_climbingState; // checks if fireball is currently not climbing, climbing up or climbing down
 };
 
-class Koopa : public Enemy {
+class Koopa final : public Enemy {
 public:
 	Koopa(StudentWorld* sw, int startX, int startY);
-	virtual void doSomething(); // controls movement, freeze player if conditions met. Decrements cooldown.
+	virtual void doSomething(); // controls movement
+	int nextWakeup() const; // ticks until doSomething() next has work to do. Koopas run from a timer wheel
 	virtual void kill(); // in addition to inherited kill(), it also drops extra life goodie with probability 1/3
-private:
-	int m_freezeCooldown; // tracks ticks left before cooldown expires
-	bool tryFreezePlayer(); // Tries to freeze player if same square and not in cooldown mode. Resets cooldown. Returns true if successfully frozen, false otherwise.
 };
 
-class Barrel : public Enemy {
+class Hunter final : public Enemy { // chases the player along StudentWorld's flow field
+public:
+	Hunter(StudentWorld* sw, int startX, int startY);
+	virtual void doSomething(); // steps towards the player once every TICK_FACTOR ticks
+	int nextWakeup() const; // next tick if falling, otherwise ticks until the next step. Hunters run from a timer wheel
+};
+
+class Barrel final : public Enemy {
 public:
 	Barrel(StudentWorld* sw, int startX, int startY, int startDirection);
-	virtual void doSomething(); // controls movement, kills player if same square
+	virtual void doSomething(); // controls movement
+	void reinit(int startX, int startY, int startDirection); // restores barrel capabilities in addition to Actor::reinit()
 };
 
 class Goodie : public Actor { // base class for all goodies
 public:
 	Goodie(StudentWorld* sw, int imageID, int startX, int startY);
 	virtual ~Goodie() = 0; // pure virtual destructor to make the class an Abstract Base Class
-	virtual void doSomething(); // manages common functionality for all goodies (sound, scope, destruction)
+	virtual void onPlayerContact(int contactType); // manages common functionality for all goodies (sound, score, destruction)
+	void reinit(int startX, int startY); // restores CAP_PICKUP in addition to Actor::reinit()
 	void setExtraPoints(int p); // setter for extra points for collecting goodie
 	int extraPoints() const; // getter for extra points for collecting goodie
 private:
@@ -140,22 +141,23 @@ private:
 
 };
 
-class ExtraLifeGoodie : public Goodie {
+class ExtraLifeGoodie final : public Goodie {
 public:
 	ExtraLifeGoodie(StudentWorld* sw, int startX, int startY);
-	virtual void doSomething(); // increment lives by 1 in addition to inherited doSomething()
+	virtual void onPlayerContact(int contactType); // increment lives by 1 in addition to inherited onPlayerContact()
 };
 
-class GarlicGoodie : public Goodie {
+class GarlicGoodie final : public Goodie {
 public:
 	GarlicGoodie(StudentWorld* sw, int startX, int startY);
-	virtual void doSomething(); // increment burps by 5 in addition to inherited doSomething()
+	virtual void onPlayerContact(int contactType); // increment burps by 5 in addition to inherited onPlayerContact()
 };
 
-class Kong : public Actor {
+class Kong final : public Actor {
 public:
 	Kong(StudentWorld* sw, int startX, int startY, int startDirection);
 	virtual void doSomething(); // manage animation, manage flee behavior, check level finish condition
+	virtual void onPlayerContact(int contactType); // starts fleeing once the player comes close
 private:
 	bool m_flee; // checks if player is close enough to Kong to flee. Initially set to false
 };
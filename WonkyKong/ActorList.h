@@ -0,0 +1,60 @@
+#ifndef ACTORLIST_H_
+#define ACTORLIST_H_
+
+#include <vector>
+#include <cstddef>
+
+// Contiguous storage for the live actors of one type, so they can be updated in a tight loop. T should
+// be a final class, which lets calls through T* (eg. doSomething()) be resolved without a virtual call.
+// Actors spawned during a tick are staged and only join the list in merge(), so it never grows while
+// it is being iterated. The list does not own its actors.
+template <typename T>
+class ActorList {
+public:
+	void stage(T* ap); // ap joins the list at the next merge()
+	size_t merge(); // appends the staged actors, in the order they were staged. Returns the index of the first one
+	void removeDead(); // drops dead actors in one stable pass. Must run before their memory is released
+	void clear(); // forgets every actor, keeping capacity for the next level
+	void reserve(size_t n); // room for n actors, both merged and staged, so neither grows until there are more
+	size_t size() const { return m_actors.size(); }
+	T* operator[](size_t i) const { return m_actors[i]; }
+private:
+	std::vector<T*> m_actors;
+	std::vector<T*> m_staged;
+};
+
+template <typename T>
+void ActorList<T>::stage(T* ap) {
+	m_staged.push_back(ap);
+}
+
+template <typename T>
+size_t ActorList<T>::merge() {
+	size_t first = m_actors.size();
+	m_actors.insert(m_actors.end(), m_staged.begin(), m_staged.end());
+	m_staged.clear();
+	return first;
+}
+
+template <typename T>
+void ActorList<T>::removeDead() {
+	size_t nAlive = 0;
+	for (size_t i = 0; i < m_actors.size(); i++) {
+		if (m_actors[i]->alive()) m_actors[nAlive++] = m_actors[i];
+	}
+	m_actors.resize(nAlive);
+}
+
+template <typename T>
+void ActorList<T>::clear() {
+	m_actors.clear();
+	m_staged.clear();
+}
+
+template <typename T>
+void ActorList<T>::reserve(size_t n) {
+	m_actors.reserve(n);
+	m_staged.reserve(n);
+}
+
+#endif // ACTORLIST_H_
@@ -0,0 +1,126 @@
+#ifndef ACTORPOOL_H_
+#define ACTORPOOL_H_
+
+#include "Actor.h"
+#include "Arena.h"
+#include <vector>
+#include <cstddef>
+
+class StudentWorld;
+
+class ActorPoolBase { // lets StudentWorld hand a dead actor back to its pool without knowing its type
+public:
+	virtual ~ActorPoolBase() {}
+	virtual void release(Actor* ap) = 0; // takes back a dead actor that came from this pool
+};
+
+// Keeps dead actors of type T for reuse. Recycled instances are reinitialised in place through
+// T::reinit(), so they skip both the arena and GraphObject registration. T must provide
+// reinit() with the same arguments as its constructor, minus the StudentWorld.
+template <typename T>
+class ActorPool : public ActorPoolBase {
+public:
+	ActorPool(StudentWorld* sw, LevelArena& arena, size_t capacity);
+	template <typename... Args>
+	T* acquire(Args... args); // recycles a free instance if there is one, otherwise constructs a new one in the arena
+	virtual void release(Actor* ap); // hides ap and keeps it for reuse. Past capacity, ap is destroyed instead
+	void clear(); // destroys every free instance and resets the statistics. Instances in use belong to the caller
+	size_t capacity() const; // most free instances kept for reuse
+	void setCapacity(size_t capacity);
+	int inUse() const; // instances acquired but not yet released
+	int highWaterMark() const; // most instances in use at once since the last clear()
+	int recycled() const; // acquisitions served from the free list since the last clear()
+	int created() const; // acquisitions that constructed a new instance since the last clear()
+private:
+	StudentWorld* m_world;
+	LevelArena& m_arena;
+	std::vector<T*> m_free; // reserved up to capacity, so release() never allocates
+	size_t m_capacity;
+	int m_inUse;
+	int m_highWaterMark;
+	int m_recycled;
+	int m_created;
+};
+
+template <typename T>
+ActorPool<T>::ActorPool(StudentWorld* sw, LevelArena& arena, size_t capacity)
+	: m_world(sw), m_arena(arena), m_capacity(capacity), m_inUse(0), m_highWaterMark(0), m_recycled(0), m_created(0) {
+	m_free.reserve(capacity);
+}
+
+template <typename T>
+template <typename... Args>
+T* ActorPool<T>::acquire(Args... args) {
+	T* ap;
+	if (!m_free.empty()) {
+		ap = m_free.back();
+		m_free.pop_back();
+		ap->reinit(args...);
+		m_recycled++;
+	}
+	else {
+		ap = m_arena.template create<T>(m_world, args...);
+		ap->setPool(this);
+		m_created++;
+	}
+	m_inUse++;
+	if (m_inUse > m_highWaterMark) m_highWaterMark = m_inUse;
+	return ap;
+}
+
+template <typename T>
+void ActorPool<T>::release(Actor* ap) {
+	m_inUse--;
+	if (m_free.size() < m_capacity) {
+		ap->setVisible(false);
+		m_free.push_back(static_cast<T*>(ap));
+	}
+	else m_arena.destroy(static_cast<T*>(ap));
+}
+
+template <typename T>
+void ActorPool<T>::clear() {
+	for (size_t i = 0; i < m_free.size(); i++) m_arena.destroy(m_free[i]);
+	m_free.clear();
+	m_inUse = 0;
+	m_highWaterMark = 0;
+	m_recycled = 0;
+	m_created = 0;
+}
+
+template <typename T>
+size_t ActorPool<T>::capacity() const {
+	return m_capacity;
+}
+
+template <typename T>
+void ActorPool<T>::setCapacity(size_t capacity) {
+	m_capacity = capacity;
+	m_free.reserve(capacity);
+	while (m_free.size() > m_capacity) {
+		m_arena.destroy(m_free.back());
+		m_free.pop_back();
+	}
+}
+
+template <typename T>
+int ActorPool<T>::inUse() const {
+	return m_inUse;
+}
+
+template <typename T>
+int ActorPool<T>::highWaterMark() const {
+	return m_highWaterMark;
+}
+
+template <typename T>
+int ActorPool<T>::recycled() const {
+	return m_recycled;
+}
+
+template <typename T>
+int ActorPool<T>::created() const {
+	return m_created;
+}
+
+#endif // ACTORPOOL_H_
@@ -0,0 +1,172 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+
+const size_t DEFAULT_ARENA_BLOCK_SIZE = 16384;
+
+// Level-scoped allocator for game objects. Memory is carved monotonically out of large blocks, and
+// destroyed objects go on a free list for their size so the next object of that size reuses them.
+// reset() hands every block back at once. Blocks are kept for the next level rather than freed.
+class LevelArena {
+public:
+	LevelArena(size_t blockSize = DEFAULT_ARENA_BLOCK_SIZE);
+	~LevelArena();
+	template <typename T, typename... Args>
+	T* create(Args... args); // constructs a T in arena memory. Arguments are taken by value, so constants like GraphObject::left need no definition
+	template <typename T>
+	void destroy(T* p); // runs p's (virtual) destructor and recycles its memory. p must come from create()
+	void reset(); // forgets every allocation. All objects must have been destroyed first
+	void reserve(size_t nObjects, size_t objectSize); // allocates blocks up front, so nObjects objects of up to objectSize bytes fit without another
+	size_t bytesUsed() const; // bytes handed out since the last reset, including headers and recycled memory
+	size_t bytesReserved() const; // bytes held in blocks
+	int objectsCreated() const; // objects created since the last reset
+	int liveObjects() const; // objects created but not yet destroyed
+private:
+	struct Block {
+		char* memory;
+		size_t size;
+	};
+	struct FreeList {
+		size_t size; // size of every chunk on this list, including the header
+		void* head; // each free chunk stores the next one in its first bytes
+	};
+	static const size_t ALIGNMENT = alignof(std::max_align_t);
+	static const size_t HEADER_SIZE = ALIGNMENT; // each object is preceded by its chunk size, so destroy() works through a base pointer
+	static const size_t FREE_LIST_CAPACITY = 16; // chunk sizes reserve() makes room for, more than there are actor types
+
+	size_t m_blockSize;
+	std::vector<Block> m_blocks;
+	size_t m_curBlock; // index of the block being carved
+	size_t m_offset; // first unused byte in the current block
+	std::vector<FreeList> m_freeLists; // one list per chunk size. Actors only come in a handful of sizes
+	size_t m_bytesUsed;
+	int m_objectsCreated;
+	int m_liveObjects;
+
+	void* allocate(size_t objectSize); // returns memory for an object of objectSize bytes
+	void deallocate(void* p); // puts the chunk holding p on its free list
+	FreeList& freeListFor(size_t chunkSize);
+
+	// Prevent copying or assigning LevelArenas
+	LevelArena(const LevelArena&);
+	LevelArena& operator=(const LevelArena&);
+};
+
+inline LevelArena::LevelArena(size_t blockSize)
+	: m_blockSize(blockSize), m_curBlock(0), m_offset(0), m_bytesUsed(0), m_objectsCreated(0), m_liveObjects(0) {
+
+}
+
+inline LevelArena::~LevelArena() {
+	for (size_t i = 0; i < m_blocks.size(); i++) ::operator delete(m_blocks[i].memory);
+}
+
+template <typename T, typename... Args>
+T* LevelArena::create(Args... args) {
+	static_assert(alignof(T) <= ALIGNMENT, "LevelArena cannot satisfy this alignment");
+	void* p = allocate(sizeof(T));
+	m_objectsCreated++;
+	m_liveObjects++;
+	return new (p) T(args...);
+}
+
+template <typename T>
+void LevelArena::destroy(T* p) {
+	if (p == nullptr) return;
+	p->~T();
+	deallocate(p);
+	m_liveObjects--;
+}
+
+inline void LevelArena::reset() {
+	m_curBlock = 0;
+	m_offset = 0;
+	m_freeLists.clear();
+	m_bytesUsed = 0;
+	m_objectsCreated = 0;
+	m_liveObjects = 0;
+}
+
+inline void LevelArena::reserve(size_t nObjects, size_t objectSize) {
+	size_t chunkSize = HEADER_SIZE + (objectSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	size_t perBlock = m_blockSize / chunkSize; // chunks never straddle two blocks
+	size_t blocks = perBlock > 0 ? (nObjects + perBlock - 1) / perBlock : nObjects;
+	m_blocks.reserve(blocks);
+	m_freeLists.reserve(FREE_LIST_CAPACITY);
+	while (m_blocks.size() < blocks) {
+		Block b;
+		b.size = chunkSize > m_blockSize ? chunkSize : m_blockSize;
+		b.memory = static_cast<char*>(::operator new(b.size));
+		m_blocks.push_back(b);
+	}
+}
+
+inline size_t LevelArena::bytesUsed() const {
+	return m_bytesUsed;
+}
+
+inline size_t LevelArena::bytesReserved() const {
+	size_t total = 0;
+	for (size_t i = 0; i < m_blocks.size(); i++) total += m_blocks[i].size;
+	return total;
+}
+
+inline int LevelArena::objectsCreated() const {
+	return m_objectsCreated;
+}
+
+inline int LevelArena::liveObjects() const {
+	return m_liveObjects;
+}
+
+inline void* LevelArena::allocate(size_t objectSize) {
+	size_t chunkSize = HEADER_SIZE + (objectSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	m_bytesUsed += chunkSize;
+
+	FreeList& fl = freeListFor(chunkSize);
+	char* chunk;
+	if (fl.head != nullptr) { // reuse a chunk released by an object of the same size
+		chunk = static_cast<char*>(fl.head);
+		fl.head = *reinterpret_cast<void**>(chunk + HEADER_SIZE);
+	}
+	else {
+		// carve from the current block, moving on to the next block that fits (or a new one) when it is full
+		while (m_curBlock < m_blocks.size() && m_offset + chunkSize > m_blocks[m_curBlock].size) {
+			m_curBlock++;
+			m_offset = 0;
+		}
+		if (m_curBlock == m_blocks.size()) {
+			Block b;
+			b.size = chunkSize > m_blockSize ? chunkSize : m_blockSize;
+			b.memory = static_cast<char*>(::operator new(b.size));
+			m_blocks.push_back(b);
+			m_offset = 0;
+		}
+		chunk = m_blocks[m_curBlock].memory + m_offset;
+		m_offset += chunkSize;
+	}
+	*reinterpret_cast<size_t*>(chunk) = chunkSize;
+	return chunk + HEADER_SIZE;
+}
+
+inline void LevelArena::deallocate(void* p) {
+	char* chunk = static_cast<char*>(p) - HEADER_SIZE;
+	FreeList& fl = freeListFor(*reinterpret_cast<size_t*>(chunk));
+	*static_cast<void**>(p) = fl.head;
+	fl.head = chunk;
+}
+
+inline LevelArena::FreeList& LevelArena::freeListFor(size_t chunkSize) {
+	for (size_t i = 0; i < m_freeLists.size(); i++) {
+		if (m_freeLists[i].size == chunkSize) return m_freeLists[i];
+	}
+	FreeList fl = { chunkSize, nullptr };
+	m_freeLists.push_back(fl);
+	return m_freeLists.back();
+}
+
+#endif // ARENA_H_
@@ -0,0 +1,216 @@
+#ifndef BITBOARD_H_
+#define BITBOARD_H_
+
+#include "GameConstants.h"
+#include <bitset>
+#include <cstdint>
+#include <cstddef>
+
+// One bit per square of the VIEW_WIDTH x VIEW_HEIGHT board, bit yy * VIEW_WIDTH + xx for square (xx, yy).
+// Shifts move the whole board one square at a time, and squares shifted in from off the board are clear,
+// which matches checkPassable() and checkClimbable() returning false off the board. So neighbourhood
+// questions about every square at once cost a handful of 64-bit operations.
+class Bitboard {
+public:
+	static const int NUM_SQUARES = VIEW_WIDTH * VIEW_HEIGHT;
+	static const int NUM_WORDS = (NUM_SQUARES + 63) / 64;
+
+	Bitboard();
+	static Bitboard full(); // every square on the board set
+	static Bitboard column(int xx); // every square with this x
+	bool test(int xx, int yy) const; // false off the board
+	void set(int xx, int yy, bool b = true); // ignored off the board
+	void clear();
+	bool any() const;
+	size_t count() const; // number of squares set
+	unsigned int row(int yy) const; // bit xx of the result is square (xx, yy)
+
+	// Each shift returns the board seen from one square over: shiftedUp().test(xx, yy) == test(xx, yy - 1), etc.
+	Bitboard shiftedUp() const; // square (xx, yy) takes the value of (xx, yy - 1), ie. what is below it
+	Bitboard shiftedDown() const; // square (xx, yy) takes the value of (xx, yy + 1)
+	Bitboard shiftedRight() const; // square (xx, yy) takes the value of (xx - 1, yy)
+	Bitboard shiftedLeft() const; // square (xx, yy) takes the value of (xx + 1, yy)
+
+	Bitboard operator&(const Bitboard& other) const;
+	Bitboard operator|(const Bitboard& other) const;
+	Bitboard operator^(const Bitboard& other) const;
+	Bitboard operator~() const; // complement within the board
+	Bitboard& operator&=(const Bitboard& other);
+	Bitboard& operator|=(const Bitboard& other);
+	bool operator==(const Bitboard& other) const;
+	bool operator!=(const Bitboard& other) const { return !(*this == other); }
+private:
+	uint64_t m_words[NUM_WORDS];
+	Bitboard shiftedBy(int n) const; // moves every bit n places towards higher indexes, or -n places towards lower ones
+	void trim(); // clears the bits past NUM_SQUARES
+};
+
+inline Bitboard::Bitboard() {
+	clear();
+}
+
+inline Bitboard Bitboard::full() {
+	Bitboard b;
+	for (int i = 0; i < NUM_WORDS; i++) b.m_words[i] = ~uint64_t(0);
+	b.trim();
+	return b;
+}
+
+inline Bitboard Bitboard::column(int xx) {
+	Bitboard b;
+	for (int yy = 0; yy < VIEW_HEIGHT; yy++) b.set(xx, yy);
+	return b;
+}
+
+inline bool Bitboard::test(int xx, int yy) const {
+	if (xx < 0 || yy < 0 || xx >= VIEW_WIDTH || yy >= VIEW_HEIGHT) return false;
+	int p = yy * VIEW_WIDTH + xx;
+	return ((m_words[p >> 6] >> (p & 63)) & 1) != 0;
+}
+
+inline void Bitboard::set(int xx, int yy, bool b) {
+	if (xx < 0 || yy < 0 || xx >= VIEW_WIDTH || yy >= VIEW_HEIGHT) return;
+	int p = yy * VIEW_WIDTH + xx;
+	if (b) m_words[p >> 6] |= uint64_t(1) << (p & 63);
+	else m_words[p >> 6] &= ~(uint64_t(1) << (p & 63));
+}
+
+inline void Bitboard::clear() {
+	for (int i = 0; i < NUM_WORDS; i++) m_words[i] = 0;
+}
+
+inline bool Bitboard::any() const {
+	for (int i = 0; i < NUM_WORDS; i++) {
+		if (m_words[i] != 0) return true;
+	}
+	return false;
+}
+
+inline size_t Bitboard::count() const {
+	size_t n = 0;
+	for (int i = 0; i < NUM_WORDS; i++) n += std::bitset<64>(m_words[i]).count();
+	return n;
+}
+
+inline unsigned int Bitboard::row(int yy) const {
+	if (yy < 0 || yy >= VIEW_HEIGHT) return 0;
+	int p = yy * VIEW_WIDTH;
+	uint64_t bits = m_words[p >> 6] >> (p & 63);
+	if ((p & 63) + VIEW_WIDTH > 64 && (p >> 6) + 1 < NUM_WORDS) bits |= m_words[(p >> 6) + 1] << (64 - (p & 63)); // row straddles two words
+	return static_cast<unsigned int>(bits & ((uint64_t(1) << VIEW_WIDTH) - 1));
+}
+
+inline Bitboard Bitboard::shiftedUp() const {
+	return shiftedBy(VIEW_WIDTH);
+}
+
+inline Bitboard Bitboard::shiftedDown() const {
+	return shiftedBy(-VIEW_WIDTH);
+}
+
+inline Bitboard Bitboard::shiftedRight() const {
+	static const Bitboard notFirstColumn = ~column(0); // the last square of each row would wrap onto the next row
+	return shiftedBy(1) & notFirstColumn;
+}
+
+inline Bitboard Bitboard::shiftedLeft() const {
+	static const Bitboard notLastColumn = ~column(VIEW_WIDTH - 1);
+	return shiftedBy(-1) & notLastColumn;
+}
+
+inline Bitboard Bitboard::shiftedBy(int n) const {
+	Bitboard b;
+	if (n >= 0) {
+		int words = n >> 6;
+		int bits = n & 63;
+		for (int i = NUM_WORDS - 1; i >= words; i--) {
+			uint64_t w = m_words[i - words] << bits;
+			if (bits != 0 && i - words - 1 >= 0) w |= m_words[i - words - 1] >> (64 - bits);
+			b.m_words[i] = w;
+		}
+		b.trim();
+	}
+	else {
+		n = -n;
+		int words = n >> 6;
+		int bits = n & 63;
+		for (int i = 0; i + words < NUM_WORDS; i++) {
+			uint64_t w = m_words[i + words] >> bits;
+			if (bits != 0 && i + words + 1 < NUM_WORDS) w |= m_words[i + words + 1] << (64 - bits);
+			b.m_words[i] = w;
+		}
+	}
+	return b;
+}
+
+inline void Bitboard::trim() {
+	if (NUM_SQUARES % 64 != 0) m_words[NUM_WORDS - 1] &= (uint64_t(1) << (NUM_SQUARES % 64)) - 1;
+}
+
+inline Bitboard Bitboard::operator&(const Bitboard& other) const {
+	Bitboard b(*this);
+	return b &= other;
+}
+
+inline Bitboard Bitboard::operator|(const Bitboard& other) const {
+	Bitboard b(*this);
+	return b |= other;
+}
+
+inline Bitboard Bitboard::operator^(const Bitboard& other) const {
+	Bitboard b;
+	for (int i = 0; i < NUM_WORDS; i++) b.m_words[i] = m_words[i] ^ other.m_words[i];
+	return b;
+}
+
+inline Bitboard Bitboard::operator~() const {
+	Bitboard b;
+	for (int i = 0; i < NUM_WORDS; i++) b.m_words[i] = ~m_words[i];
+	b.trim();
+	return b;
+}
+
+inline Bitboard& Bitboard::operator&=(const Bitboard& other) {
+	for (int i = 0; i < NUM_WORDS; i++) m_words[i] &= other.m_words[i];
+	return *this;
+}
+
+inline Bitboard& Bitboard::operator|=(const Bitboard& other) {
+	for (int i = 0; i < NUM_WORDS; i++) m_words[i] |= other.m_words[i];
+	return *this;
+}
+
+inline bool Bitboard::operator==(const Bitboard& other) const {
+	for (int i = 0; i < NUM_WORDS; i++) {
+		if (m_words[i] != other.m_words[i]) return false;
+	}
+	return true;
+}
+
+// Whole-board answers about a level's static terrain, worked out once in StudentWorld::init() rather than
+// square by square as actors move. Gameplay code and anything planning over the board can share them
+struct TerrainBitboards {
+	Bitboard walls; // floor squares
+	Bitboard ladders; // checkClimbable()
+	Bitboard passable; // checkPassable(): no wall, and not on the bottom row or left column
+	Bitboard hazards; // bonfires, which never move
+	Bitboard canFall; // Player gravity: not on or above a ladder, and the square below is passable
+	Bitboard onLadder; // on a ladder or standing at its top, so a ladder can be climbed from here
+	Bitboard cliffLeft; // Enemy::checkCliffInDirection() facing left: the square down and to the left is passable and not a ladder
+	Bitboard cliffRight; // the same facing right
+	Bitboard walkable; // squares an enemy can step onto: passable, with a floor or ladder below
+
+	void derive(); // works out the other boards from walls, ladders and passable. hazards is set alongside those three
+};
+
+inline void TerrainBitboards::derive() {
+	Bitboard below = passable.shiftedUp(); // square below is passable
+	Bitboard dropOff = passable & ~ladders; // an enemy stepping above this square would fall
+	onLadder = ladders | ladders.shiftedUp();
+	canFall = below & ~onLadder;
+	cliffLeft = dropOff.shiftedUp().shiftedRight();
+	cliffRight = dropOff.shiftedUp().shiftedLeft();
+	walkable = passable & ~dropOff.shiftedUp();
+}
+
+#endif // BITBOARD_H_
@@ -0,0 +1,84 @@
+#ifndef COMPONENTS_H_
+#define COMPONENTS_H_
+
+#include "SlotMap.h"
+#include <vector>
+#include <cstddef>
+
+class Actor;
+
+typedef SlotHandle Entity; // an entity is identified by its actor's handle. Its components live at row handle.index
+
+// Capability flags, combined in ComponentArrays::flags
+const int CAP_ALIVE = 1 << 0; // takes part in the game. Cleared when killed
+const int CAP_BLASTABLE = 1 << 1; // destroyed by burps
+const int CAP_BURNABLE = 1 << 2; // destroyed by bonfires
+const int CAP_HARMFUL = 1 << 3; // kills the player on contact
+const int CAP_FREEZES = 1 << 4; // freezes the player on contact, subject to a cooldown
+const int CAP_AVOIDS_CLIFFS = 1 << 5; // lateral patrol turns around at the edge of a platform
+const int CAP_HELD_BY_LADDERS = 1 << 6; // gravity does not apply on or directly above a ladder
+const int CAP_PICKUP = 1 << 7; // collected by the player on contact
+const int CAP_FLEES = 1 << 8; // starts fleeing once the player comes within MIN_EUCLID_DISTANCE
+
+// Contact event types, numbered in the order StudentWorld resolves them within a tick
+const int CONTACT_DAMAGE = 0; // a CAP_HARMFUL entity shares the player's square. The player dies
+const int CONTACT_FREEZE = 1; // a CAP_FREEZES entity off cooldown shares the player's square
+const int CONTACT_PICKUP = 2; // a CAP_PICKUP entity shares the player's square
+const int CONTACT_FLEE = 3; // a CAP_FLEES entity is within MIN_EUCLID_DISTANCE of the player
+const int NUM_CONTACT_TYPES = 4;
+
+struct ContactEvent { // one entity touching the player during a tick's contact phase
+	int type; // CONTACT_*
+	Entity entity;
+};
+
+// Struct-of-arrays state for every entity in StudentWorld, one row per handle index. Rows are
+// reinitialised whenever a slot is reused, and the arrays only grow, so steady-state ticks don't allocate.
+struct ComponentArrays {
+	std::vector<int> x; // position, kept in step with the entity's GraphObject
+	std::vector<int> y;
+	std::vector<int> direction; // GraphObject direction (left, right or none)
+	std::vector<int> ticks; // tick phase: ticks since creation, modulo MAX_MOD_FACTOR
+	std::vector<int> flags; // CAP_* capability flags
+	std::vector<int> climbingState; // STATE_NOT_CLIMBING, STATE_CLIMBING_UP or STATE_CLIMBING_DOWN
+	std::vector<int> freezeReadyTick; // StudentWorld::currentTick() from which the entity can freeze the player again
+	std::vector<Actor*> actor; // the Actor that renders this entity and carries its type-specific behaviour
+
+	size_t size() const { return flags.size(); }
+	void initRow(size_t i, Actor* ap, int xx, int yy, int dir); // makes row i a fresh, alive entity, growing the arrays if needed
+	void reserve(size_t n); // room for n rows, so rows below n never allocate
+};
+
+inline void ComponentArrays::initRow(size_t i, Actor* ap, int xx, int yy, int dir) {
+	if (i >= size()) {
+		x.resize(i + 1);
+		y.resize(i + 1);
+		direction.resize(i + 1);
+		ticks.resize(i + 1);
+		flags.resize(i + 1);
+		climbingState.resize(i + 1);
+		freezeReadyTick.resize(i + 1);
+		actor.resize(i + 1);
+	}
+	x[i] = xx;
+	y[i] = yy;
+	direction[i] = dir;
+	ticks[i] = 0;
+	flags[i] = CAP_ALIVE;
+	climbingState[i] = 0;
+	freezeReadyTick[i] = 0;
+	actor[i] = ap;
+}
+
+inline void ComponentArrays::reserve(size_t n) {
+	x.reserve(n);
+	y.reserve(n);
+	direction.reserve(n);
+	ticks.reserve(n);
+	flags.reserve(n);
+	climbingState.reserve(n);
+	freezeReadyTick.reserve(n);
+	actor.reserve(n);
+}
+
+#endif // COMPONENTS_H_
@@ -0,0 +1,111 @@
+#ifndef FLOWFIELD_H_
+#define FLOWFIELD_H_
+
+#include "GameConstants.h"
+#include "Bitboard.h"
+
+// Shortest paths to one target square (the player) from every square of the board, over the moves the
+// player itself can make: walk left or right, climb a ladder, and fall when nothing holds it up. The
+// movement graph is built once per level. The distances are only recomputed when the target moves to a
+// new square, so any number of chasers can look up their next step for free.
+class FlowField {
+public:
+	static const int UNREACHABLE = -1;
+
+	FlowField();
+	void build(const TerrainBitboards& terrain); // works out the movement graph for a level and forgets the target
+	void update(int targetX, int targetY); // recomputes the field if (targetX, targetY) differs from the last target
+	int distance(int xx, int yy) const; // moves from (xx, yy) to the target, or UNREACHABLE
+	bool nextStep(int xx, int yy, int& nextX, int& nextY) const; // first square on a shortest path to the target. False at the target or if there is no path
+	int recomputations() const; // times update() actually rebuilt the field since build()
+private:
+	enum { MOVE_LEFT, MOVE_RIGHT, MOVE_UP, MOVE_DOWN, NUM_MOVES };
+	static int moveDX(int m) { return m == MOVE_LEFT ? -1 : (m == MOVE_RIGHT ? 1 : 0); }
+	static int moveDY(int m) { return m == MOVE_UP ? 1 : (m == MOVE_DOWN ? -1 : 0); }
+
+	unsigned char m_moves[VIEW_HEIGHT][VIEW_WIDTH]; // bit m is set if move m can be made from the square
+	short m_distance[VIEW_HEIGHT][VIEW_WIDTH];
+	signed char m_next[VIEW_HEIGHT][VIEW_WIDTH]; // move to make from the square, or -1
+	short m_queue[VIEW_WIDTH * VIEW_HEIGHT]; // breadth-first search frontier, as yy * VIEW_WIDTH + xx
+	int m_targetX;
+	int m_targetY;
+	int m_recomputations;
+};
+
+inline FlowField::FlowField() {
+	build(TerrainBitboards());
+}
+
+inline void FlowField::build(const TerrainBitboards& terrain) {
+	for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+		for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+			unsigned char moves = 0;
+			if (terrain.canFall.test(xx, yy)) moves = 1 << MOVE_DOWN; // falling is the only option
+			else if (terrain.passable.test(xx, yy)) {
+				if (terrain.passable.test(xx - 1, yy)) moves |= 1 << MOVE_LEFT;
+				if (terrain.passable.test(xx + 1, yy)) moves |= 1 << MOVE_RIGHT;
+				if (terrain.ladders.test(xx, yy) && terrain.passable.test(xx, yy + 1)) moves |= 1 << MOVE_UP;
+				if (terrain.onLadder.test(xx, yy) && terrain.passable.test(xx, yy - 1)) moves |= 1 << MOVE_DOWN;
+			}
+			m_moves[yy][xx] = moves;
+			m_distance[yy][xx] = UNREACHABLE;
+			m_next[yy][xx] = -1;
+		}
+	}
+	m_targetX = -1;
+	m_targetY = -1;
+	m_recomputations = 0;
+}
+
+inline void FlowField::update(int targetX, int targetY) {
+	if (targetX == m_targetX && targetY == m_targetY) return;
+	m_targetX = targetX;
+	m_targetY = targetY;
+	m_recomputations++;
+	for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+		for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+			m_distance[yy][xx] = UNREACHABLE;
+			m_next[yy][xx] = -1;
+		}
+	}
+	if (targetX < 0 || targetY < 0 || targetX >= VIEW_WIDTH || targetY >= VIEW_HEIGHT) return;
+
+	// Search backwards from the target: a square joins the field when one of its moves leads to a square already
+	// in it. Moves are tried in a fixed order, so ties always break the same way
+	int head = 0;
+	int tail = 0;
+	m_distance[targetY][targetX] = 0;
+	m_queue[tail++] = static_cast<short>(targetY * VIEW_WIDTH + targetX);
+	while (head < tail) {
+		int xx = m_queue[head] % VIEW_WIDTH;
+		int yy = m_queue[head] / VIEW_WIDTH;
+		head++;
+		for (int m = 0; m < NUM_MOVES; m++) {
+			int fromX = xx - moveDX(m);
+			int fromY = yy - moveDY(m);
+			if (fromX < 0 || fromY < 0 || fromX >= VIEW_WIDTH || fromY >= VIEW_HEIGHT) continue;
+			if (!(m_moves[fromY][fromX] & (1 << m)) || m_distance[fromY][fromX] != UNREACHABLE) continue;
+			m_distance[fromY][fromX] = static_cast<short>(m_distance[yy][xx] + 1);
+			m_next[fromY][fromX] = static_cast<signed char>(m);
+			m_queue[tail++] = static_cast<short>(fromY * VIEW_WIDTH + fromX);
+		}
+	}
+}
+
+inline int FlowField::distance(int xx, int yy) const {
+	if (xx < 0 || yy < 0 || xx >= VIEW_WIDTH || yy >= VIEW_HEIGHT) return UNREACHABLE;
+	return m_distance[yy][xx];
+}
+
+inline bool FlowField::nextStep(int xx, int yy, int& nextX, int& nextY) const {
+	if (xx < 0 || yy < 0 || xx >= VIEW_WIDTH || yy >= VIEW_HEIGHT || m_next[yy][xx] < 0) return false;
+	nextX = xx + moveDX(m_next[yy][xx]);
+	nextY = yy + moveDY(m_next[yy][xx]);
+	return true;
+}
+
+inline int FlowField::recomputations() const {
+	return m_recomputations;
+}
+
+#endif // FLOWFIELD_H_
@@ -1,9 +1,6 @@
 #ifndef GAMECONSTANTS_H_
 #define GAMECONSTANTS_H_
 
-#include <random>
-#include <utility>
-
 // image IDs for the game objects
 
 const int IID_PLAYER = 0;
@@ -17,6 +14,9 @@ const int IID_EXTRA_LIFE_GOODIE = 7;
 const int IID_GARLIC_GOODIE = 8;
 const int IID_BONFIRE = 9;
 const int IID_BURP = 10;
+const int IID_HUNTER = 11;
+
+const int IID_NONE = -1;
 
 // sounds
 
@@ -64,17 +64,4 @@ const int MAX_LEVELS = 99;
 const double SPRITE_WIDTH_GL = .48; // note - this is tied implicitly to SPRITE_WIDTH due to carey's sloppy openGL programming
 const double SPRITE_HEIGHT_GL = .4; // note - this is tied implicitly to SPRITE_HEIGHT due to carey's sloppy openGL programming
 
-// Return a uniformly distributed random int from min to max, inclusive
-
-inline
-int randInt(int min, int max)
-{
-	if (max < min)
-		std::swap(max, min);
-	static std::random_device rd;
-	static std::default_random_engine generator(rd());
-	std::uniform_int_distribution<> distro(min, max);
-	return distro(generator);
-}
-
 #endif // GAMECONSTANTS_H_
@@ -9,9 +9,12 @@
 #include "GraphObject.h"
 #include "SoundFX.h"
 #include "SpriteManager.h"
+#include "SpriteInfo.h"
+#include "Random.h"
 #include <iostream>
 #include <string>
 #include <map>
+#include <set>
 #include <utility>
 #include <cstdlib>
 #include <algorithm>
@@ -55,15 +58,6 @@ static const double FONT_SCALEDOWN = 760.0;
 static const double SCORE_Y = 3.8;
 static const double SCORE_Z = -10;
 
-struct SpriteInfo
-{
-	unsigned int imageID;
-	unsigned int frameNum;
-	std::string	 tgaFileName;
-	std::string	 imageName;
-	int			 depth;
-};
-
 static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz);
 static void drawPrompt(string mainMessage, string secondMessage);
 static void drawScoreAndLives(string);
@@ -76,27 +70,6 @@ int GameController::m_msPerTick;
 
 void GameController::initDrawersAndSounds()
 {
-	SpriteInfo drawers[] = {
-		{ IID_PLAYER, 0, "mario1.tga", "PLAYER", 0 },
-		{ IID_PLAYER, 1, "mario2.tga", "PLAYER", 0 },
-		{ IID_KONG, 0, "kong1.tga", "KONG", 0 },
-		{ IID_KONG, 1, "kong2.tga", "KONG", 0 },
-		{ IID_KONG, 2, "kong3.tga", "KONG", 0 },
-		{ IID_BARREL, 0, "barrel1.tga", "BARREL", 1 },
-		{ IID_BARREL, 1, "barrel2.tga", "BARREL", 1 },
-		{ IID_BARREL, 2, "barrel3.tga", "BARREL", 1 },
-		{ IID_FIREBALL, 0, "fire1.tga", "FIREBALL", 1 },
-		{ IID_KOOPA, 0, "koopa1.tga", "KOOPA", 0 },
-		{ IID_KOOPA, 1, "koopa2.tga", "KOOPA", 0 },
-		{ IID_FLOOR, 0, "wall.tga", "FLOOR", 2 },
-		{ IID_LADDER, 0, "ladder.tga", "LADDER", 3 }, 
-		{ IID_EXTRA_LIFE_GOODIE, 0, "extralife.tga", "EXTRA_LIFE_GOODIE", 2 },
-		{ IID_GARLIC_GOODIE, 0, "garlic.tga", "GARLIC_GOODIE", 2 },
-		{ IID_BONFIRE, 0, "bonfire1.tga", "BONFIRE", 3 },
-		{ IID_BONFIRE, 1, "bonfire2.tga", "BONFIRE", 3 },
-		{ IID_BURP, 0, "gascloud.tga", "BURP", 1 },
-	};
-
 	m_soundMap = {
 		{ SOUND_THEME,          "theme.wav" },
 		{ SOUND_ENEMY_DIE,      "enemydie.wav" },
@@ -107,7 +80,7 @@ void GameController::initDrawersAndSounds()
 		{ SOUND_JUMP,           "jumpbar.wav" },
 	};
 
-	for (const auto& d : drawers)
+	for (const auto& d : SPRITES)
 	{
 		string path = m_gw->assetPath();
 		if (!path.empty())
@@ -193,8 +166,7 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 
 	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 	glutMainLoop();
-	delete m_gw;
-	reportLeakedGraphObjects();
+	delete m_gw; // reports leaked objects
 }
 
 void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
@@ -405,10 +377,30 @@ void GameController::displayGamePlay()
 #pragma GCC diagnostic pop
 #endif
 
-  std::set<GraphObject*>& graphObjects = GraphObject::getGraphObjects();
+  std::vector<GraphObject*>& graphObjects = m_gw->graphObjects();
+
+	  // Static tiles are not GraphObjects; fetch them once per frame.
+	int tiles[VIEW_HEIGHT][VIEW_WIDTH];
+	for (int y = 0; y < VIEW_HEIGHT; y++)
+		for (int x = 0; x < VIEW_WIDTH; x++)
+			tiles[y][x] = m_gw->getTileImageID(x, y);
 
 	for (int i = GraphObject::NUM_DEPTHS - 1; i >= 0; --i)
 	{
+		for (int y = 0; y < VIEW_HEIGHT; y++)
+		{
+			for (int x = 0; x < VIEW_WIDTH; x++)
+			{
+				int imageID = tiles[y][x];
+				if (imageID != IID_NONE && m_imageDepthMap.at(imageID) == i)
+				{
+					double gx, gy, gz;
+					convertToGlutCoords(x, y, gx, gy, gz);
+					m_spriteManager.plotSprite(imageID, 0, gx, gy, gz, GraphObject::none, 1.0);
+				}
+			}
+		}
+
 		for (auto it = graphObjects.begin(); it != graphObjects.end(); it++)
 		{
 			GraphObject* cur = *it;
@@ -433,10 +425,9 @@ void GameController::displayGamePlay()
 	glutSwapBuffers();
 }
 
-void GameController::reportLeakedGraphObjects() const
+void GameController::reportLeakedGraphObjects(const std::vector<GraphObject*>& graphObjects)
 {
 	//int totalLeaked = 0;
-	auto& graphObjects = GraphObject::getGraphObjects();
 	if (graphObjects.empty())
 		cerr << "No memory leaks were detected." << endl;
 	else
@@ -518,11 +509,12 @@ static void drawPrompt(string mainMessage, string secondMessage)
 static void drawScoreAndLives(string gameStatText)
 {
 	static int RATE = 1;
+	static Random flicker(0); // display only, so it has a stream of its own and never disturbs the game's
 	static GLfloat rgb[3] =
 		{ static_cast<GLfloat>(.6), static_cast<GLfloat>(.6), static_cast<GLfloat>(.6) };
 	for (int k = 0; k < 3; k++)
 	{
-		double strength = rgb[k] + randInt(-RATE, RATE) / 100.0;
+		double strength = rgb[k] + flicker.intIn(-RATE, RATE) / 100.0;
 		if (strength < .6)
 			strength = .6;
 		else if (strength > 1.0)
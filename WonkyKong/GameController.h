@@ -2,21 +2,21 @@
 #define GAMECONTROLLER_H_
 
 #include "SpriteManager.h"
+#include "GameHost.h"
 #include <string>
 #include <map>
 #include <iostream>
 #include <sstream>
-const int INVALID_KEY = 0;
 
 class GraphObject;
 class GameWorld;
 
-class GameController
+class GameController : public GameHost
 {
   public:
 	void run(int argc, char* argv[], GameWorld* gw, std::string windowTitle, int msPerTick);
 
-	bool getKeyIfAny(int& value)
+	virtual bool getKeyIfAny(int& value)
 	{
 		if (m_lastKeyHit != INVALID_KEY)
 		{
@@ -32,9 +32,9 @@ class GameController
 		m_lastKeyHit = key;
 	}
 
-	void playSound(int soundID);
+	virtual void playSound(int soundID);
 
-	void setGameStatText(std::string text)
+	virtual void setGameStatText(const std::string& text)
 	{
 		m_gameStatText = text;
 	}
@@ -46,7 +46,8 @@ class GameController
 	void specialKeyboardEvent(int key, int x, int y);
 	static void timerFuncCallback(int);
 
-	void quitGame();
+	virtual void quitGame();
+	virtual void reportLeakedGraphObjects(const std::vector<GraphObject*>& graphObjects);
 
 	  // Meyers singleton pattern
 	static GameController& getInstance()
@@ -82,7 +83,6 @@ private:
 	void initDrawersAndSounds();
 	bool passesThruWhenSingleStepping(int key) const;
 	void displayGamePlay();
-	void reportLeakedGraphObjects() const;
 
 };
 
@@ -0,0 +1,26 @@
+#ifndef GAMEHOST_H_
+#define GAMEHOST_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+const int INVALID_KEY = 0;
+const size_t GAME_STAT_TEXT_CAPACITY = 64; // characters reserved for the game stats text, more than it ever runs to
+
+class GraphObject;
+
+// What a GameWorld needs from whatever is running it: key presses in, sounds and the game stats text out,
+// and a way to ask to quit. GameController is the windowed host. HeadlessHost runs worlds without GLUT,
+// OpenGL or sound
+class GameHost {
+public:
+	virtual ~GameHost() {}
+	virtual bool getKeyIfAny(int& value) = 0; // the key hit since the last call, if any
+	virtual void playSound(int soundID) = 0;
+	virtual void setGameStatText(const std::string& text) = 0;
+	virtual void quitGame() = 0;
+	virtual void reportLeakedGraphObjects(const std::vector<GraphObject*>& graphObjects) = 0; // objects a world still held once it was destroyed
+};
+
+#endif // GAMEHOST_H_
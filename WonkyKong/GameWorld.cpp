@@ -1,5 +1,5 @@
 #include "GameWorld.h"
-#include "GameController.h"
+#include "GameHost.h"
 #include <string>
 #include <cstdlib>
 using namespace std;
@@ -21,7 +21,15 @@ void GameWorld::playSound(int soundID)
 	m_controller->playSound(soundID);
 }
 
-void GameWorld::setGameStatText(string text)
+void GameWorld::setGameStatText(const string& text)
 {
 	m_controller->setGameStatText(text);
 }
+
+GameWorld::~GameWorld()
+{
+	  // The derived world and its members are gone by now, so whatever is
+	  // still in the set was never deleted
+	if (m_controller != nullptr)
+		m_controller->reportLeakedGraphObjects(m_graphObjects);
+}
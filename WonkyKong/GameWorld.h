@@ -3,10 +3,12 @@
 
 #include "GameConstants.h"
 #include <string>
+#include <vector>
 
 const int START_PLAYER_LIVES = 3;
 
-class GameController;
+class GameHost;
+class GraphObject;
 
 class GameWorld
 {
@@ -18,15 +20,20 @@ public:
 	{
 	}
 
-	virtual ~GameWorld()
-	{
-	}
+	virtual ~GameWorld();
 
 	virtual int init() = 0;
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
-	void setGameStatText(std::string text);
+	  // Static scenery that is drawn without a GraphObject.  Return the image
+	  // ID of the tile at (x, y), or IID_NONE if there is nothing there.
+	virtual int getTileImageID(int /* x */, int /* y */) const
+	{
+		return IID_NONE;
+	}
+
+	void setGameStatText(const std::string& text);
 
 	bool getKey(int& value);
 	void playSound(int soundID);
@@ -73,7 +80,7 @@ public:
 		++m_level;
 	}
  
-	void setController(GameController* controller)
+	void setController(GameHost* controller)
 	{
 		m_controller = controller;
 	}
@@ -83,12 +90,35 @@ public:
 		return m_assetPath;
 	}
 
+	  // Every GraphObject in this world, in no particular order, for drawing.
+	  // Each world has its own, so any number of worlds can run at once.
+	  // Only GraphObject adds and removes entries
+	std::vector<GraphObject*>& graphObjects()
+	{
+		return m_graphObjects;
+	}
+
+	const std::vector<GraphObject*>& graphObjects() const
+	{
+		return m_graphObjects;
+	}
+
+	  // Back to the first level with full lives and no score, for drivers
+	  // that play game after game in one world. Call between cleanUp() and init()
+	void resetGame()
+	{
+		m_lives = START_PLAYER_LIVES;
+		m_score = 0;
+		m_level = 0;
+	}
+
 private:
 	int				m_lives;
 	int				m_score;
 	int				m_level;
-	GameController* m_controller;
+	GameHost*		m_controller;
 	std::string		m_assetPath;
+	std::vector<GraphObject*>	m_graphObjects;
 };
 
 #endif // GAMEWORLD_H_
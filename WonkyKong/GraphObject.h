@@ -1,10 +1,9 @@
 #ifndef GRAPHOBJ_H_
 #define GRAPHOBJ_H_
 
-#include "SpriteManager.h"
 #include "GameConstants.h"
 
-#include <set>
+#include <vector>
 #include <cmath>
 
 const int ANIMATION_POSITIONS_PER_TICK = 1;
@@ -19,21 +18,28 @@ class GraphObject
 	static const int up = 90;
 	static const int down = 270;
 
-	GraphObject(int imageID, int startX, int startY, int dir = 0, double size = 1.0)
-	 : m_imageID(imageID), m_visible(true), m_x(startX), m_y(startY),
+	  // graphObjects is the list the object is drawn from, normally its world's GameWorld::graphObjects(),
+	  // so worlds running side by side never touch each other's objects
+	GraphObject(std::vector<GraphObject*>& graphObjects, int imageID, int startX, int startY, int dir = 0, double size = 1.0)
+	 : m_graphObjects(&graphObjects), m_graphIndex(graphObjects.size()), m_imageID(imageID), m_visible(true), m_x(startX), m_y(startY),
 	   m_destX(startX), m_destY(startY), m_brightness(1.0),
 	   m_animationNumber(0), m_direction(dir), m_size(size)
 	{
 		if (m_size <= 0)
 			m_size = 1;
 
-		getGraphObjects().insert(this);
+		m_graphObjects->push_back(this);
 		setVisible(true);
 	}
 
 	virtual ~GraphObject()
 	{
-		getGraphObjects().erase(this);
+		  // The last object takes this one's place, so removal is constant
+		  // time and the list never gives back its capacity
+		GraphObject* last = m_graphObjects->back();
+		(*m_graphObjects)[m_graphIndex] = last;
+		last->m_graphIndex = m_graphIndex;
+		m_graphObjects->pop_back();
 	}
 
 	void setVisible(bool shouldIDisplay)
@@ -141,6 +147,11 @@ class GraphObject
 		return m_animationNumber;
 	}
 
+	int getImageID() const
+	{
+		return m_imageID;
+	}
+
 	void getAnimationLocation(double& x, double& y) const
 	{
 		x = m_x;
@@ -155,15 +166,20 @@ class GraphObject
 		//moveALittle(m_y, m_destY);
 	}
 
-	static std::set<GraphObject*>& getGraphObjects()
+	void increaseAnimationNumber()
 	{
-		static std::set<GraphObject*> graphObjects;
-		return graphObjects;
+		m_animationNumber++;
 	}
 
-	void increaseAnimationNumber()
+	  // Put a recycled object back in the state the constructor leaves it in
+	void reset(int x, int y, int dir)
 	{
-		m_animationNumber++;
+		m_x = m_destX = x;
+		m_y = m_destY = y;
+		m_direction = dir;
+		m_brightness = 1.0;
+		m_animationNumber = 0;
+		setVisible(true);
 	}
 
 
@@ -180,6 +196,8 @@ private:
 	GraphObject& operator=(const GraphObject&);
 
 	static const int NUM_DEPTHS = 4;
+	std::vector<GraphObject*>*	m_graphObjects;
+	size_t	m_graphIndex;	// where this object is in *m_graphObjects
 	int		m_imageID;
 	bool	m_visible;
 	int		m_x;
@@ -0,0 +1,52 @@
+#include "HeadlessHost.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+HeadlessHost::HeadlessHost()
+	: m_pendingKey(INVALID_KEY), m_quitRequested(false), m_soundsPlayed(0), m_graphObjectsLeaked(0) {
+	m_gameStatText.reserve(GAME_STAT_TEXT_CAPACITY); // so copying the world's text in doesn't allocate
+}
+
+void HeadlessHost::pressKey(int key) {
+	m_pendingKey = key;
+}
+
+bool HeadlessHost::getKeyIfAny(int& value) {
+	if (m_pendingKey == INVALID_KEY) return false;
+	value = m_pendingKey;
+	m_pendingKey = INVALID_KEY;
+	return true;
+}
+
+void HeadlessHost::playSound(int /* soundID */) {
+	m_soundsPlayed++;
+}
+
+void HeadlessHost::setGameStatText(const string& text) {
+	m_gameStatText = text;
+}
+
+void HeadlessHost::quitGame() {
+	m_quitRequested = true;
+}
+
+void HeadlessHost::reportLeakedGraphObjects(const vector<GraphObject*>& graphObjects) {
+	m_graphObjectsLeaked += graphObjects.size();
+}
+
+bool HeadlessHost::quitRequested() const {
+	return m_quitRequested;
+}
+
+long long HeadlessHost::soundsPlayed() const {
+	return m_soundsPlayed;
+}
+
+const string& HeadlessHost::gameStatText() const {
+	return m_gameStatText;
+}
+
+long long HeadlessHost::graphObjectsLeaked() const {
+	return m_graphObjectsLeaked;
+}
@@ -0,0 +1,32 @@
+#ifndef HEADLESSHOST_H_
+#define HEADLESSHOST_H_
+
+#include "GameHost.h"
+#include <string>
+#include <vector>
+
+// GameHost for running a world with no window, OpenGL or sound. The driver feeds keys with pressKey()
+// between ticks. Sounds are only counted, the game stats text is kept for the driver to read, and a
+// request to quit just raises a flag
+class HeadlessHost : public GameHost {
+public:
+	HeadlessHost();
+	void pressKey(int key); // key returned by the next getKeyIfAny(), like a key hit between two ticks
+	virtual bool getKeyIfAny(int& value);
+	virtual void playSound(int soundID);
+	virtual void setGameStatText(const std::string& text);
+	virtual void quitGame();
+	virtual void reportLeakedGraphObjects(const std::vector<GraphObject*>& graphObjects);
+	bool quitRequested() const; // set once the world asked to quit (eg. the player pressed q)
+	long long soundsPlayed() const; // sounds the world asked for since construction
+	const std::string& gameStatText() const; // last game stats text the world set
+	long long graphObjectsLeaked() const; // objects left behind by worlds destroyed so far
+private:
+	int m_pendingKey; // INVALID_KEY if no key is waiting
+	bool m_quitRequested;
+	long long m_soundsPlayed;
+	std::string m_gameStatText;
+	long long m_graphObjectsLeaked;
+};
+
+#endif // HEADLESSHOST_H_
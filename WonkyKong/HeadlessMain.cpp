@@ -0,0 +1,692 @@
+#include "WorldBatch.h"
+#include "HeadlessHost.h"
+#include "StudentWorld.h"
+#include "ObservationEncoder.h"
+#include "SoftwareRenderer.h"
+#include "GameConstants.h"
+#include "GraphObject.h"
+#include "Random.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+using namespace std;
+
+  // Runs levels with no window, OpenGL or sound, as fast as the CPU allows, and reports ticks per second.
+  //
+  //   wonkykong_headless [-a assetDir] [-t ticks] [-s seed] [-k keyFile] [-n worlds] [-j threads] [-c] [-e]
+  //                      [-r WIDTHxHEIGHT] [-p frameFile] [-b] [-x] [-d] [-v]
+  //
+  // Keys come from keyFile, one whitespace-separated token per tick (left, right, up, down, space, tab,
+  // or none/. for no key), starting over at the end of the file. Without a key file a random key is
+  // pressed on about one tick in four. With -n, that many worlds run side by side and -j threads step
+  // them in parallel; a single world spends its threads on its own update instead. When a game ends a
+  // new one starts in its place, until every world has run the given number of ticks. -c runs the same
+  // batch at 1, 2, 4, ... threads up to the number of cores and reports the steps per second of each.
+  // -e also encodes every world's tensor observation after each step, in each layout and element type,
+  // both from scratch and incrementally, and reports the nanoseconds per world of each. -r draws every
+  // world's frame at that size after each step, in greyscale and RGBA with each filter, and reports the
+  // frames per second of each; -p writes world 0's last RGBA frame to frameFile as a PPM image. -b instead
+  // runs one world with more and more barrels in it, for the given ticks at each count, and reports the
+  // time per tick and per actor, which should stay flat as the count grows. -x instead churns one world's
+  // actors, spawning and burning dozens of barrels a tick, checks the world's actor and graph object
+  // counts agree throughout, and exits nonzero if they ever don't. -d instead runs the batch twice side by
+  // side, once moving barrels as a batch on the given threads and once one at a time, and exits nonzero at
+  // the first tick the two differ.
+  // Diagnostics the world writes to cerr are dropped unless -v is given.
+
+const string defaultAssetDirectory = "Assets";
+const long long defaultTicks = 100000;
+const int RANDOM_KEY_ONE_IN = 4; // chance of a random key on a tick, when there is no key file
+
+int keyFromToken(const string& token)
+{
+	if (token == "left")  return KEY_PRESS_LEFT;
+	if (token == "right") return KEY_PRESS_RIGHT;
+	if (token == "up")    return KEY_PRESS_UP;
+	if (token == "down")  return KEY_PRESS_DOWN;
+	if (token == "space") return KEY_PRESS_SPACE;
+	if (token == "tab")   return KEY_PRESS_TAB;
+	if (token == "none" || token == ".") return INVALID_KEY;
+	return -1;
+}
+
+bool loadKeys(const string& path, vector<int>& keys)
+{
+	ifstream ifs(path);
+	if (!ifs)
+	{
+		cout << "Cannot open key file " << path << endl;
+		return false;
+	}
+	string token;
+	while (ifs >> token)
+	{
+		int key = keyFromToken(token);
+		if (key < 0)
+		{
+			cout << "Unknown key \"" << token << "\" in " << path << endl;
+			return false;
+		}
+		keys.push_back(key);
+	}
+	return true;
+}
+
+int randomKey(Random& random)
+{
+	static const int keys[] = { KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN, KEY_PRESS_SPACE };
+	if (!random.oneIn(RANDOM_KEY_ONE_IN)) return INVALID_KEY;
+	return keys[random.intIn(0, sizeof(keys) / sizeof(keys[0]) - 1)];
+}
+
+void usage()
+{
+	cout << "usage: wonkykong_headless [-a assetDir] [-t ticks] [-s seed] [-k keyFile] [-n worlds] [-j threads] [-c] [-e]" << endl;
+	cout << "                          [-r WIDTHxHEIGHT] [-p frameFile] [-b] [-x] [-d] [-v]" << endl;
+}
+
+struct RunOptions
+{
+	string assetPath;
+	long long ticks;
+	uint64_t seed;
+	vector<int> keys; // empty for random keys
+	int worlds;
+	bool encode; // time the observation encoder after every step
+	int frameWidth; // time the software renderer after every step, unless 0
+	int frameHeight;
+	string frameFile; // where to write world 0's last frame, if anywhere
+	bool diagnostics; // let the worlds report on each level to cerr
+};
+
+  // Times encoding a batch's observations in one layout and element type, into a batch-sized buffer as a
+  // trainer would, both from scratch and by incremental updates to a second buffer
+template <typename T>
+struct EncodeTimer
+{
+	EncodeTimer(const string& name, int layout, int worlds)
+		: name(name), layout(layout), encoders(worlds), scratch(worlds), full(worlds * OBS_SIZE), incremental(worlds * OBS_SIZE), fullNs(0), incrementalNs(0), changed(0) {}
+	string name;
+	int layout;
+	vector<ObservationEncoder> encoders; // one per world, for the incremental buffer
+	vector<ObservationEncoder> scratch; // one per world, for the full buffer
+	vector<T> full;
+	vector<T> incremental;
+	long long fullNs;
+	long long incrementalNs;
+	long long changed; // rows or squares the incremental updates rewrote
+
+	void time(WorldBatch& batch)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < batch.size(); i++)
+			scratch[i].encode(batch.world(i), layout, &full[i * OBS_SIZE]);
+		auto middle = chrono::steady_clock::now();
+		for (int i = 0; i < batch.size(); i++)
+		{
+			encoders[i].update(batch.world(i), layout, &incremental[i * OBS_SIZE]);
+			changed += encoders[i].lastChanged();
+		}
+		auto end = chrono::steady_clock::now();
+		fullNs += chrono::duration_cast<chrono::nanoseconds>(middle - start).count();
+		incrementalNs += chrono::duration_cast<chrono::nanoseconds>(end - middle).count();
+	}
+
+	void report(long long encodes) const
+	{
+		bool same = full == incremental; // both were written from the same world state, so must agree
+		cout << "  encode " << name << ": " << (encodes > 0 ? fullNs / encodes : 0) << " ns/world, incremental "
+			 << (encodes > 0 ? incrementalNs / encodes : 0) << " ns/world (" << (encodes > 0 ? static_cast<double>(changed) / encodes : 0)
+			 << (layout == OBS_LAYOUT_NCHW ? " rows" : " squares") << " rewritten)" << (same ? "" : ", MISMATCH") << endl;
+	}
+};
+
+  // Times drawing a batch's frames in one pixel format and filter, into a batch-sized buffer
+struct RenderTimer
+{
+	RenderTimer(const string& name, SpriteSheet& sprites, int width, int height, int channels, int filter, int worlds)
+		: name(name), frameSize(static_cast<size_t>(width) * height * channels), frames(worlds * frameSize), ns(0)
+	{
+		for (int i = 0; i < worlds; i++)
+			renderers.push_back(SoftwareRenderer(sprites, width, height, channels, filter));
+	}
+	string name;
+	vector<SoftwareRenderer> renderers; // one per world, each keeping the terrain it last drew
+	size_t frameSize;
+	vector<uint8_t> frames;
+	long long ns;
+
+	void time(WorldBatch& batch)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < batch.size(); i++)
+			renderers[i].render(batch.world(i), &frames[i * frameSize]);
+		ns += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	}
+
+	void report(long long renders) const
+	{
+		cout << "  render " << name << ": " << (renders > 0 ? ns / renders : 0) << " ns/frame, "
+			 << (ns > 0 ? renders * 1e9 / ns : 0) << " frames/sec" << endl;
+	}
+
+	  // Writes world 0's frame as a binary PPM, dropping the alpha of RGBA
+	bool write(const string& path) const
+	{
+		ofstream ofs(path, ios::binary);
+		if (!ofs)
+		{
+			cout << "Cannot write frame file " << path << endl;
+			return false;
+		}
+		const SoftwareRenderer& r = renderers[0];
+		ofs << "P6\n" << r.width() << " " << r.height() << "\n255\n";
+		for (int p = 0; p < r.width() * r.height(); p++)
+			ofs.write(reinterpret_cast<const char*>(&frames[p * r.channels()]), 3);
+		return static_cast<bool>(ofs);
+	}
+};
+
+  // Runs a batch on nThreads for opt.ticks ticks per world, and prints what happened and how fast
+bool runBatch(const RunOptions& opt, int nThreads)
+{
+	WorldBatch batch(opt.assetPath, opt.worlds, nThreads, opt.seed);
+	batch.setDiagnostics(opt.diagnostics);
+	if (!batch.reset())
+	{
+		cout << "Error in level data file encoding!" << endl;
+		return false;
+	}
+	batch.resetWorkerStats(); // count only the stepping, not building the worlds
+	Random keyRandom(opt.seed);
+	vector<int> keys(opt.worlds);
+	size_t nextKey = 0;
+	long long ticks = 0;
+	bool ok = true;
+	vector<EncodeTimer<uint8_t>> byteTimers;
+	vector<EncodeTimer<float>> floatTimers;
+	if (opt.encode)
+	{
+		byteTimers.push_back(EncodeTimer<uint8_t>("uint8 NCHW", OBS_LAYOUT_NCHW, opt.worlds));
+		byteTimers.push_back(EncodeTimer<uint8_t>("uint8 NHWC", OBS_LAYOUT_NHWC, opt.worlds));
+		floatTimers.push_back(EncodeTimer<float>("float NCHW", OBS_LAYOUT_NCHW, opt.worlds));
+		floatTimers.push_back(EncodeTimer<float>("float NHWC", OBS_LAYOUT_NHWC, opt.worlds));
+	}
+	SpriteSheet sprites;
+	vector<RenderTimer> renderTimers;
+	if (opt.frameWidth > 0)
+	{
+		if (!sprites.load(opt.assetPath))
+			return false;
+		renderTimers.push_back(RenderTimer("grey nearest", sprites, opt.frameWidth, opt.frameHeight, PIXELS_GREY, FILTER_NEAREST, opt.worlds));
+		renderTimers.push_back(RenderTimer("grey bilinear", sprites, opt.frameWidth, opt.frameHeight, PIXELS_GREY, FILTER_BILINEAR, opt.worlds));
+		renderTimers.push_back(RenderTimer("RGBA nearest", sprites, opt.frameWidth, opt.frameHeight, PIXELS_RGBA, FILTER_NEAREST, opt.worlds));
+		renderTimers.push_back(RenderTimer("RGBA bilinear", sprites, opt.frameWidth, opt.frameHeight, PIXELS_RGBA, FILTER_BILINEAR, opt.worlds));
+	}
+	double observeSeconds = 0; // spent encoding and drawing, which steps/sec leaves out
+
+	auto start = chrono::steady_clock::now();
+	for (; ticks < opt.ticks && ok; ticks++)
+	{
+		for (int i = 0; i < opt.worlds; i++)
+			keys[i] = opt.keys.empty() ? randomKey(keyRandom) : opt.keys[(nextKey + i) % opt.keys.size()];
+		if (!opt.keys.empty())
+			nextKey = (nextKey + 1) % opt.keys.size();
+		ok = batch.step(keys.data());
+		if (opt.encode && ok)
+		{
+			auto encodeStart = chrono::steady_clock::now();
+			for (size_t k = 0; k < byteTimers.size(); k++)
+				byteTimers[k].time(batch);
+			for (size_t k = 0; k < floatTimers.size(); k++)
+				floatTimers[k].time(batch);
+			observeSeconds += chrono::duration<double>(chrono::steady_clock::now() - encodeStart).count();
+		}
+		if (!renderTimers.empty() && ok)
+		{
+			auto renderStart = chrono::steady_clock::now();
+			for (size_t k = 0; k < renderTimers.size(); k++)
+				renderTimers[k].time(batch);
+			observeSeconds += chrono::duration<double>(chrono::steady_clock::now() - renderStart).count();
+		}
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() - observeSeconds; // steps/sec counts only the stepping
+	if (!ok)
+	{
+		cout << "Error in level data file encoding!" << endl;
+		return false;
+	}
+
+	long long steps = ticks * opt.worlds;
+	cout << batch.size() << " worlds on " << batch.threads() << " threads: "
+		 << steps << " steps, " << batch.episodes() << " games, " << batch.levelsFinished() << " levels finished, "
+		 << batch.deaths() << " deaths, " << batch.soundsPlayed() << " sounds" << endl;
+	cout << "  " << seconds << " s, " << (seconds > 0 ? steps / seconds : 0) << " steps/sec" << endl;
+	const WorkerPool& workers = batch.workers();
+	for (int w = 0; w < workers.size(); w++)
+	{
+		const WorkerPool::WorkerStats& stats = workers.stats(w);
+		cout << "  worker " << w << ": " << (workers.jobNs() > 0 ? 100 * stats.busyNs / workers.jobNs() : 0) << "% busy, "
+			 << stats.chunks << " steps, " << stats.steals << " steals" << endl;
+	}
+	for (size_t k = 0; k < byteTimers.size(); k++)
+		byteTimers[k].report(steps);
+	for (size_t k = 0; k < floatTimers.size(); k++)
+		floatTimers[k].report(steps);
+	for (size_t k = 0; k < renderTimers.size(); k++)
+		renderTimers[k].report(steps);
+	if (!opt.frameFile.empty() && !renderTimers.empty())
+		return renderTimers.back().write(opt.frameFile);
+	return true;
+}
+
+  // Describes graph object o for a mismatch report
+string describe(const GraphObject* o)
+{
+	if (o == nullptr)
+		return "nothing";
+	return "image " + to_string(o->getImageID()) + " at (" + to_string(o->getX()) + ", " + to_string(o->getY()) + ") facing "
+		+ to_string(o->getDirection()) + ", frame " + to_string(o->getAnimationNumber()) + (o->isVisible() ? "" : ", hidden");
+}
+
+  // Steps two batches of the same worlds side by side for opt.ticks ticks with the same keys, one moving
+  // barrels in a batch on nThreads threads and one moving each barrel through its own doSomething() on
+  // one, and compares every world's graph objects, score, lives and step result after every tick. The
+  // first difference is printed as a MISMATCH, and fails the run.
+bool runDifferential(const RunOptions& opt, int nThreads)
+{
+	WorldBatch batched(opt.assetPath, opt.worlds, nThreads, opt.seed);
+	WorldBatch single(opt.assetPath, opt.worlds, 1, opt.seed);
+	batched.setDiagnostics(opt.diagnostics);
+	single.setDiagnostics(opt.diagnostics);
+	if (!batched.reset() || !single.reset())
+	{
+		cout << "Error in level data file encoding!" << endl;
+		return false;
+	}
+	for (int i = 0; i < single.size(); i++)
+		single.world(i).setBarrelBatching(false); // kept across games, as a batch reuses its worlds
+	Random keyRandom(opt.seed);
+	vector<int> keys(opt.worlds);
+	size_t nextKey = 0;
+	long long barrelTurns = 0;
+	for (long long t = 0; t < opt.ticks; t++)
+	{
+		for (int i = 0; i < opt.worlds; i++)
+			keys[i] = opt.keys.empty() ? randomKey(keyRandom) : opt.keys[(nextKey + i) % opt.keys.size()];
+		if (!opt.keys.empty())
+			nextKey = (nextKey + 1) % opt.keys.size();
+		if (!batched.step(keys.data()) || !single.step(keys.data()))
+		{
+			cout << "Error in level data file encoding!" << endl;
+			return false;
+		}
+		for (int i = 0; i < opt.worlds; i++)
+		{
+			const StudentWorld& a = batched.world(i);
+			const StudentWorld& b = single.world(i);
+			const WorldStep& ra = batched.result(i);
+			const WorldStep& rb = single.result(i);
+			if (a.getScore() != b.getScore() || a.getLives() != b.getLives() || ra.reward != rb.reward || ra.status != rb.status || ra.done != rb.done)
+			{
+				cout << "MISMATCH at tick " << t << " in world " << i << ": score " << a.getScore() << " and " << b.getScore()
+					 << ", lives " << a.getLives() << " and " << b.getLives() << ", status " << ra.status << " and " << rb.status << endl;
+				return false;
+			}
+			const vector<GraphObject*>& oa = a.graphObjects();
+			const vector<GraphObject*>& ob = b.graphObjects();
+			for (size_t k = 0; k < oa.size() || k < ob.size(); k++)
+			{
+				const GraphObject* ga = k < oa.size() ? oa[k] : nullptr;
+				const GraphObject* gb = k < ob.size() ? ob[k] : nullptr;
+				if (describe(ga) != describe(gb))
+				{
+					cout << "MISMATCH at tick " << t << " in world " << i << ", graph object " << k << ": " << describe(ga)
+						 << " batched, " << describe(gb) << " one at a time" << endl;
+					return false;
+				}
+				if (ga->isVisible() && ga->getImageID() == IID_BARREL)
+					barrelTurns++;
+			}
+		}
+	}
+	cout << batched.size() << " worlds, " << opt.ticks << " ticks: " << batched.episodes() << " games, " << batched.deaths() << " deaths, "
+		 << barrelTurns << " barrel turns, batched and one at a time the same" << endl;
+	return true;
+}
+
+const int BENCH_BARRELS[] = { 0, 100, 200, 400, 800, 1600, 3200 }; // barrels kept in the world by runScaling()
+
+  // Carries a world on past a death or a finished level the way WorldBatch does, starting a new game
+  // when one ends, and calls afterCleanUp() between cleaning up a level and starting the next. False if a
+  // level can't be loaded
+template <typename Func>
+bool carryOn(StudentWorld& world, int status, Func afterCleanUp)
+{
+	if (status == GWSTATUS_PLAYER_DIED)
+	{
+		world.cleanUp();
+		afterCleanUp();
+		if (world.isGameOver())
+			world.resetGame();
+		status = world.init();
+	}
+	else if (status == GWSTATUS_FINISHED_LEVEL)
+	{
+		world.advanceToNextLevel();
+		world.cleanUp();
+		afterCleanUp();
+		status = world.init();
+		if (status == GWSTATUS_PLAYER_WON)
+		{
+			world.resetGame();
+			status = world.init();
+		}
+	}
+	return status != GWSTATUS_LEVEL_ERROR;
+}
+
+  // Runs one world for opt.ticks ticks at each count in BENCH_BARRELS, topping the world up to that many
+  // barrels before every tick, and prints the time per tick and per actor turn. Only step() is timed, not
+  // the topping up or the level changes. Placing barrels and pressing no keys, it is best run on a level
+  // like Assets/bench, where the player is walled in and there are no bonfires to burn the barrels.
+bool runScaling(const RunOptions& opt)
+{
+	HeadlessHost host;
+	StudentWorld world(opt.assetPath);
+	world.setController(&host);
+	world.setDiagnostics(opt.diagnostics);
+	world.setSeed(opt.seed);
+	if (world.init() == GWSTATUS_LEVEL_ERROR)
+	{
+		cout << "Error in level data file encoding!" << endl;
+		return false;
+	}
+	Random placement(opt.seed);
+	for (size_t c = 0; c < sizeof(BENCH_BARRELS) / sizeof(BENCH_BARRELS[0]); c++)
+	{
+		long long ns = 0;
+		long long turns = 0;
+		for (long long t = 0; t < opt.ticks; t++)
+		{
+			int barrels = 0;
+			const vector<GraphObject*>& objects = world.graphObjects();
+			for (size_t i = 0; i < objects.size(); i++)
+				if (objects[i]->isVisible() && objects[i]->getImageID() == IID_BARREL)
+					barrels++;
+			const Player* player = world.getPlayer();
+			for (int tries = 0; barrels < BENCH_BARRELS[c] && tries < 16 * BENCH_BARRELS[c]; tries++)
+			{
+				int x = placement.intIn(1, VIEW_WIDTH - 2);
+				int y = placement.intIn(1, VIEW_HEIGHT - 2);
+				if (!world.checkPassable(x, y) || (x == player->getX() && y == player->getY()))
+					continue;
+				world.createBarrel(x, y, placement.oneIn(2) ? GraphObject::left : GraphObject::right);
+				barrels++;
+			}
+			auto start = chrono::steady_clock::now();
+			int status = world.step(INVALID_KEY);
+			ns += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+			turns += world.activeActorCount();
+			if (!carryOn(world, status, [] {}))
+			{
+				cout << "Error in level data file encoding!" << endl;
+				return false;
+			}
+		}
+		cout << "  " << BENCH_BARRELS[c] << " barrels: " << (opt.ticks > 0 ? static_cast<double>(turns) / opt.ticks : 0)
+			 << " actors/tick, " << (opt.ticks > 0 ? ns / opt.ticks : 0) << " ns/tick, "
+			 << (turns > 0 ? static_cast<double>(ns) / turns : 0) << " ns/actor" << endl;
+	}
+	return true;
+}
+
+const int STRESS_BARRELS = 400; // runStress() keeps up to this many barrels, more than the barrel pool keeps for reuse
+const int STRESS_SPAWNS_PER_TICK = 40; // barrels it adds on random squares each tick, below STRESS_BARRELS
+
+  // Counts visible graph objects, which is every live actor's: pooled actors waiting for reuse are hidden
+int visibleObjects(const StudentWorld& world)
+{
+	int visible = 0;
+	const vector<GraphObject*>& objects = world.graphObjects();
+	for (size_t i = 0; i < objects.size(); i++)
+		if (objects[i]->isVisible())
+			visible++;
+	return visible;
+}
+
+  // Churns one world's actors as hard as the game allows, for opt.ticks ticks. Before every tick a barrel is
+  // put on every bonfire, to burn on its next turn, and more are thrown on random squares; random keys,
+  // burps included, kill the player often and start levels over. After every tick the visible graph
+  // objects must be exactly the world's actors, after every cleanUp() there must be no graph objects left,
+  // and once the world is destroyed its host must have seen no leaks. Prints MISMATCH and fails otherwise.
+  // Best run on a level with many bonfires, like Assets/stress.
+bool runStress(const RunOptions& opt)
+{
+	HeadlessHost host;
+	StudentWorld* world = new StudentWorld(opt.assetPath);
+	world->setController(&host);
+	world->setDiagnostics(opt.diagnostics);
+	world->setSeed(opt.seed);
+	Random random(opt.seed);
+	vector<int> bonfireXs;
+	vector<int> bonfireYs;
+	long long placed = 0;
+	long long removed = 0; // actors gone from one tick to the next, net of the ones placed and spawned
+	long long levels = 0;
+	int peak = 0;
+	bool ok = true;
+	auto findBonfires = [&]() {
+		bonfireXs.clear();
+		bonfireYs.clear();
+		const vector<GraphObject*>& objects = world->graphObjects();
+		for (size_t i = 0; i < objects.size(); i++)
+			if (objects[i]->getImageID() == IID_BONFIRE)
+			{
+				bonfireXs.push_back(objects[i]->getX());
+				bonfireYs.push_back(objects[i]->getY());
+			}
+	};
+	auto checkCleanedUp = [&]() {
+		levels++;
+		if (!world->graphObjects().empty() || world->actorCount() != 0)
+		{
+			cout << "MISMATCH after cleanUp(): " << world->graphObjects().size() << " graph objects and "
+				 << world->actorCount() << " actors left" << endl;
+			ok = false;
+		}
+	};
+	if (world->init() == GWSTATUS_LEVEL_ERROR)
+	{
+		cout << "Error in level data file encoding!" << endl;
+		delete world;
+		return false;
+	}
+	findBonfires();
+	long long t = 0;
+	for (; t < opt.ticks && ok; t++)
+	{
+		int barrels = 0;
+		const vector<GraphObject*>& objects = world->graphObjects();
+		for (size_t i = 0; i < objects.size(); i++)
+			if (objects[i]->isVisible() && objects[i]->getImageID() == IID_BARREL)
+				barrels++;
+		int before = world->actorCount();
+		for (size_t b = 0; b < bonfireXs.size(); b++)
+			world->createBarrel(bonfireXs[b], bonfireYs[b], random.oneIn(2) ? GraphObject::left : GraphObject::right);
+		int spawns = bonfireXs.size();
+		for (int n = 0; n < STRESS_SPAWNS_PER_TICK && barrels + n < STRESS_BARRELS; n++)
+		{
+			int x = random.intIn(1, VIEW_WIDTH - 2);
+			int y = random.intIn(1, VIEW_HEIGHT - 2);
+			if (!world->checkPassable(x, y))
+				continue;
+			world->createBarrel(x, y, random.oneIn(2) ? GraphObject::left : GraphObject::right);
+			spawns++;
+		}
+		placed += spawns;
+		int key = random.oneIn(3) ? KEY_PRESS_TAB : randomKey(random);
+		int status = world->step(key);
+		int after = world->actorCount();
+		if (after > peak)
+			peak = after;
+		if (before + spawns > after)
+			removed += before + spawns - after;
+		if (visibleObjects(*world) != after)
+		{
+			cout << "MISMATCH at tick " << t << ": " << visibleObjects(*world) << " visible graph objects but "
+				 << after << " actors" << endl;
+			ok = false;
+			break;
+		}
+		if (status != GWSTATUS_CONTINUE_GAME)
+		{
+			if (!carryOn(*world, status, checkCleanedUp))
+			{
+				cout << "Error in level data file encoding!" << endl;
+				ok = false;
+				break;
+			}
+			findBonfires();
+		}
+	}
+	delete world;
+	if (host.graphObjectsLeaked() != 0)
+	{
+		cout << "MISMATCH: " << host.graphObjectsLeaked() << " graph objects leaked" << endl;
+		ok = false;
+	}
+	cout << "stress: " << t << " ticks, " << placed << " barrels placed, " << removed << " actors removed, "
+		 << levels << " levels cleaned up, at most " << peak << " actors" << (ok ? "" : ", FAILED") << endl;
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	string assetDirectory = defaultAssetDirectory;
+	RunOptions opt;
+	opt.ticks = defaultTicks;
+	opt.seed = 1;
+	opt.worlds = 1;
+	opt.encode = false;
+	opt.frameWidth = 0;
+	opt.frameHeight = 0;
+	opt.diagnostics = false;
+	string keyFile;
+	int threads = 1;
+	bool compare = false;
+	bool scaling = false;
+	bool stress = false;
+	bool differential = false;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "-v")
+		{
+			opt.diagnostics = true;
+			continue;
+		}
+		if (arg == "-c")
+		{
+			compare = true;
+			continue;
+		}
+		if (arg == "-e")
+		{
+			opt.encode = true;
+			continue;
+		}
+		if (arg == "-b")
+		{
+			scaling = true;
+			continue;
+		}
+		if (arg == "-x")
+		{
+			stress = true;
+			continue;
+		}
+		if (arg == "-d")
+		{
+			differential = true;
+			continue;
+		}
+		if (i + 1 >= argc || arg.size() != 2 || arg[0] != '-')
+		{
+			usage();
+			return 1;
+		}
+		string value = argv[++i];
+		switch (arg[1])
+		{
+		  case 'a':  assetDirectory = value;  break;
+		  case 't':  opt.ticks = atoll(value.c_str());  break;
+		  case 's':  opt.seed = strtoull(value.c_str(), nullptr, 10);  break;
+		  case 'k':  keyFile = value;  break;
+		  case 'n':  opt.worlds = atoi(value.c_str());  break;
+		  case 'j':  threads = atoi(value.c_str());  break;
+		  case 'p':  opt.frameFile = value;  break;
+		  case 'r':
+		  {
+			size_t by = value.find('x');
+			opt.frameWidth = atoi(value.substr(0, by).c_str());
+			opt.frameHeight = by == string::npos ? 0 : atoi(value.substr(by + 1).c_str());
+			if (opt.frameWidth < 1 || opt.frameHeight < 1)
+			{
+				usage();
+				return 1;
+			}
+			break;
+		  }
+		  default:   usage();  return 1;
+		}
+	}
+	if (opt.worlds < 1)
+		opt.worlds = 1;
+	if (!opt.frameFile.empty() && opt.frameWidth == 0)
+	{
+		opt.frameWidth = 20 * VIEW_WIDTH; // a full-size board, twenty pixels a square
+		opt.frameHeight = 20 * VIEW_HEIGHT;
+	}
+
+	opt.assetPath = assetDirectory;
+	if (!opt.assetPath.empty())
+		opt.assetPath += '/';
+	{
+		const string someAsset = "level00.txt";
+		ifstream ifs(opt.assetPath + someAsset);
+		if (!ifs)
+		{
+			cout << "Cannot find " << someAsset << " in ";
+			cout << (assetDirectory.empty() ? "current directory" : assetDirectory) << endl;
+			return 1;
+		}
+	}
+	if (!keyFile.empty() && !loadKeys(keyFile, opt.keys))
+		return 1;
+
+	if (scaling)
+		return runScaling(opt) ? 0 : 1;
+	if (stress)
+		return runStress(opt) ? 0 : 1;
+	if (differential)
+		return runDifferential(opt, threads) ? 0 : 1;
+	if (!compare)
+		return runBatch(opt, threads) ? 0 : 1;
+	int cores = static_cast<int>(thread::hardware_concurrency());
+	if (cores < 1)
+		cores = 1;
+	for (int n = 1; ; n *= 2)
+	{
+		if (n > cores)
+			n = cores;
+		if (!runBatch(opt, n))
+			return 1;
+		if (n == cores)
+			break;
+	}
+}
@@ -0,0 +1,101 @@
+#ifndef LADDERGRAPH_H_
+#define LADDERGRAPH_H_
+
+#include "GameConstants.h"
+#include "Bitboard.h"
+#include "PlatformSegments.h"
+#include <vector>
+
+// A level's ladders and the platforms they join, built once per level. Each ladder is a vertical run of
+// ladder squares. Its foot is the platform an enemy stands on at the bottom rung, and its head is the one
+// it steps onto above the top rung. The per-square climb table is filled in from the ladders as they are
+// found, and answers the questions Fireball asks every move (can I go up from here, can I go down from
+// here) with a single lookup.
+class LadderGraph {
+public:
+	struct Platform {
+		int y; // row an enemy on the platform stands in
+		int left; // ends of the platform's patrol segment, from PlatformSegments
+		int right;
+	};
+	struct Ladder {
+		int x;
+		int bottomY; // lowest ladder square
+		int topY; // highest ladder square
+		Platform foot; // platform at the bottom of the ladder, through (x, bottomY)
+		Platform head; // platform at the top of the ladder, through (x, topY + 1)
+	};
+
+	LadderGraph();
+	void build(const TerrainBitboards& terrain, const PlatformSegments& platforms); // recomputes the graph for a level
+	const std::vector<Ladder>& ladders() const { return m_ladders; }
+	int ladderAt(int xx, int yy) const; // index into ladders() of the ladder on square (xx, yy), or -1
+	bool canClimbUp(int xx, int yy) const; // on a ladder with room above: checkClimbable(xx, yy) && checkPassable(xx, yy + 1)
+	bool canClimbDown(int xx, int yy) const; // a ladder below: checkClimbable(xx, yy - 1)
+	bool ladderContinuesDown(int xx, int yy) const; // a ladder below that can be moved onto: checkPassable(xx, yy - 1) && checkClimbable(xx, yy - 1)
+private:
+	static const unsigned char CLIMB_UP = 1;
+	static const unsigned char CLIMB_DOWN = 2;
+	static const unsigned char CONTINUES_DOWN = 4;
+
+	std::vector<Ladder> m_ladders;
+	short m_ladderAt[VIEW_HEIGHT][VIEW_WIDTH];
+	unsigned char m_climb[VIEW_HEIGHT][VIEW_WIDTH]; // CLIMB_* flags for each square
+};
+
+inline LadderGraph::LadderGraph() {
+	m_ladders.reserve(VIEW_WIDTH * (VIEW_HEIGHT + 1) / 2); // the most a board has room for, so build() never allocates
+	build(TerrainBitboards(), PlatformSegments());
+}
+
+inline void LadderGraph::build(const TerrainBitboards& terrain, const PlatformSegments& platforms) {
+	for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+		for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+			m_climb[yy][xx] = 0;
+			m_ladderAt[yy][xx] = -1;
+		}
+	}
+
+	m_ladders.clear();
+	for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+		for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+			if (!terrain.ladders.test(xx, yy) || terrain.ladders.test(xx, yy - 1)) continue; // not the bottom rung
+			Ladder l;
+			l.x = xx;
+			l.bottomY = yy;
+			l.topY = yy;
+			while (terrain.ladders.test(xx, l.topY + 1)) l.topY++;
+			int headY = l.topY + 1 < VIEW_HEIGHT ? l.topY + 1 : l.topY;
+			Platform foot = { l.bottomY, platforms.leftEnd(xx, l.bottomY), platforms.rightEnd(xx, l.bottomY) };
+			Platform head = { headY, platforms.leftEnd(xx, headY), platforms.rightEnd(xx, headY) };
+			l.foot = foot;
+			l.head = head;
+			for (int ly = l.bottomY; ly <= l.topY; ly++) {
+				m_ladderAt[ly][xx] = static_cast<short>(m_ladders.size());
+				// the climb table is a per-square view of the ladder: up from a rung with room above, down onto it from the square above
+				if (terrain.passable.test(xx, ly + 1)) m_climb[ly][xx] |= CLIMB_UP;
+				if (ly + 1 < VIEW_HEIGHT) m_climb[ly + 1][xx] |= CLIMB_DOWN | (terrain.passable.test(xx, ly) ? CONTINUES_DOWN : 0);
+			}
+			m_ladders.push_back(l);
+		}
+	}
+}
+
+inline int LadderGraph::ladderAt(int xx, int yy) const {
+	if (xx < 0 || yy < 0 || xx >= VIEW_WIDTH || yy >= VIEW_HEIGHT) return -1;
+	return m_ladderAt[yy][xx];
+}
+
+inline bool LadderGraph::canClimbUp(int xx, int yy) const {
+	return (m_climb[yy][xx] & CLIMB_UP) != 0;
+}
+
+inline bool LadderGraph::canClimbDown(int xx, int yy) const {
+	return (m_climb[yy][xx] & CLIMB_DOWN) != 0;
+}
+
+inline bool LadderGraph::ladderContinuesDown(int xx, int yy) const {
+	return (m_climb[yy][xx] & CONTINUES_DOWN) != 0;
+}
+
+#endif // LADDERGRAPH_H_
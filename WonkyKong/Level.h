@@ -13,7 +13,7 @@ public:
 
 	enum MazeEntry {
 		empty, player, left_kong, right_kong, floor, ladder, bonfire,
-		fireball, koopa, extra_life, garlic
+		fireball, koopa, extra_life, garlic, hunter
 	};
 	enum LoadResult {
 		load_success, load_fail_file_not_found, load_fail_bad_format};
@@ -73,6 +73,7 @@ public:
 					case 'K':  me = koopa; break;
 					case 'E':  me = extra_life; break;
 					case 'G':  me = garlic; break;
+					case 'H':  me = hunter; break;
 				}
 				m_maze[y][x] = me;
 			}
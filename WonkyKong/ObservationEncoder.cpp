@@ -0,0 +1,169 @@
+#include "ObservationEncoder.h"
+#include "StudentWorld.h"
+#include "Actor.h"
+#include "GraphObject.h"
+#include <vector>
+#include <cstring>
+
+namespace {
+	struct ExpandTables { // bit masks to runs of 0 and 1 elements
+		uint8_t bytes[256][8]; // bytes[m][k] is bit k of m
+		float floats[16][4]; // floats[m][k] is bit k of m
+		ExpandTables() {
+			for (int m = 0; m < 256; m++) {
+				for (int k = 0; k < 8; k++) bytes[m][k] = (m >> k) & 1;
+			}
+			for (int m = 0; m < 16; m++) {
+				for (int k = 0; k < 4; k++) floats[m][k] = static_cast<float>((m >> k) & 1);
+			}
+		}
+	};
+	const ExpandTables s_expand;
+
+	const int imagePlanes[] = { // by IID_*. -1 for the terrain images, which come from the terrain bitboards
+		OBS_PLANE_PLAYER, OBS_PLANE_KONG, OBS_PLANE_BARREL, OBS_PLANE_FIREBALL, OBS_PLANE_KOOPA, -1, -1,
+		OBS_PLANE_EXTRA_LIFE, OBS_PLANE_GARLIC, OBS_PLANE_BONFIRE, OBS_PLANE_BURP, OBS_PLANE_HUNTER
+	};
+	const int NUM_IMAGE_PLANES = sizeof(imagePlanes) / sizeof(imagePlanes[0]);
+
+	// Writes bits 0 to n - 1 of mask to out as 0s and 1s, eight at a time
+	inline void expandBits(unsigned int mask, int n, uint8_t* out) {
+		int k = 0;
+		for (; k + 8 <= n; k += 8) std::memcpy(out + k, s_expand.bytes[(mask >> k) & 0xff], 8);
+		if (k < n) std::memcpy(out + k, s_expand.bytes[(mask >> k) & 0xff], n - k);
+	}
+
+	// The same for floats, four at a time, so each copy is one 16-byte store
+	inline void expandBits(unsigned int mask, int n, float* out) {
+		int k = 0;
+		for (; k + 4 <= n; k += 4) std::memcpy(out + k, s_expand.floats[(mask >> k) & 0xf], 4 * sizeof(float));
+		if (k < n) std::memcpy(out + k, s_expand.floats[(mask >> k) & 0xf], (n - k) * sizeof(float));
+	}
+
+	inline void setScalar(uint8_t& out, int value) {
+		out = static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+	}
+
+	inline void setScalar(float& out, int value) {
+		out = static_cast<float>(value);
+	}
+}
+
+ObservationEncoder::ObservationEncoder()
+	: m_gathered(0), m_writtenOut(nullptr), m_writtenLayout(OBS_LAYOUT_NCHW), m_writtenElementSize(0), m_lastChanged(0) {
+	std::memset(m_rows, 0, sizeof(m_rows));
+	std::memset(m_cells, 0, sizeof(m_cells));
+	std::memset(m_terrainRows, 0, sizeof(m_terrainRows)); // matches the empty m_floors and m_ladders
+	std::memset(m_terrainCells, 0, sizeof(m_terrainCells));
+}
+
+void ObservationEncoder::encode(const StudentWorld& sw, int layout, uint8_t* out) {
+	write(sw, layout, out, false);
+}
+
+void ObservationEncoder::encode(const StudentWorld& sw, int layout, float* out) {
+	write(sw, layout, out, false);
+}
+
+void ObservationEncoder::update(const StudentWorld& sw, int layout, uint8_t* out) {
+	write(sw, layout, out, true);
+}
+
+void ObservationEncoder::update(const StudentWorld& sw, int layout, float* out) {
+	write(sw, layout, out, true);
+}
+
+void ObservationEncoder::invalidate() {
+	m_writtenOut = nullptr;
+}
+
+int ObservationEncoder::lastChanged() const {
+	return m_lastChanged;
+}
+
+void ObservationEncoder::gather(const StudentWorld& sw, bool cells) {
+	// Terrain only changes with the level, so its rows and cell masks are rebuilt only when it differs
+	const TerrainBitboards& terrain = sw.terrainBoards();
+	if (terrain.walls != m_floors || terrain.ladders != m_ladders) {
+		m_floors = terrain.walls;
+		m_ladders = terrain.ladders;
+		for (int r = 0; r < VIEW_HEIGHT; r++) {
+			m_terrainRows[0][r] = m_floors.row(VIEW_HEIGHT - 1 - r);
+			m_terrainRows[1][r] = m_ladders.row(VIEW_HEIGHT - 1 - r);
+			for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+				m_terrainCells[r][xx] = static_cast<CellMask>((((m_terrainRows[0][r] >> xx) & 1) << OBS_PLANE_FLOOR) | (((m_terrainRows[1][r] >> xx) & 1) << OBS_PLANE_LADDER));
+			}
+		}
+	}
+
+	unsigned int (&rows)[NUM_OBS_PLANES][VIEW_HEIGHT] = m_rows[m_gathered];
+	std::memset(rows, 0, sizeof(rows));
+	std::memcpy(rows[OBS_PLANE_FLOOR], m_terrainRows[0], sizeof(m_terrainRows[0]));
+	std::memcpy(rows[OBS_PLANE_LADDER], m_terrainRows[1], sizeof(m_terrainRows[1]));
+	if (cells) std::memcpy(m_cells, m_terrainCells, sizeof(m_cells));
+	const std::vector<GraphObject*>& objects = sw.graphObjects();
+	for (size_t i = 0; i < objects.size(); i++) {
+		const GraphObject* go = objects[i];
+		int image = go->getImageID();
+		int xx = go->getX();
+		int yy = go->getY();
+		if (!go->isVisible() || image < 0 || image >= NUM_IMAGE_PLANES || imagePlanes[image] < 0) continue;
+		if (xx < 0 || yy < 0 || xx >= VIEW_WIDTH || yy >= VIEW_HEIGHT) continue;
+		int p = imagePlanes[image];
+		int r = VIEW_HEIGHT - 1 - yy;
+		rows[p][r] |= 1u << xx;
+		if (cells) m_cells[r][xx] |= static_cast<CellMask>(1u << p);
+	}
+}
+
+template <typename T>
+void ObservationEncoder::write(const StudentWorld& sw, int layout, T* out, bool incremental) {
+	gather(sw, layout == OBS_LAYOUT_NHWC);
+	if (m_writtenOut != out || m_writtenLayout != layout || m_writtenElementSize != sizeof(T)) incremental = false; // the buffer holds something else
+	const unsigned int (&rows)[NUM_OBS_PLANES][VIEW_HEIGHT] = m_rows[m_gathered];
+	const unsigned int (&written)[NUM_OBS_PLANES][VIEW_HEIGHT] = m_rows[1 - m_gathered];
+	int changed = 0;
+	if (layout == OBS_LAYOUT_NHWC) {
+		unsigned int diff[VIEW_HEIGHT]; // squares of each row that differ in any plane
+		for (int r = 0; r < VIEW_HEIGHT; r++) diff[r] = incremental ? 0 : (1u << VIEW_WIDTH) - 1;
+		if (incremental) {
+			for (int p = 0; p < NUM_OBS_PLANES; p++) { // plane by plane, so the inner loop runs down contiguous rows and vectorises
+				for (int r = 0; r < VIEW_HEIGHT; r++) diff[r] |= rows[p][r] ^ written[p][r];
+			}
+		}
+		for (int r = 0; r < VIEW_HEIGHT; r++) {
+			for (int xx = 0; diff[r] != 0; xx++, diff[r] >>= 1) {
+				if ((diff[r] & 1) == 0) continue;
+				expandBits(m_cells[r][xx], NUM_OBS_PLANES, out + (r * VIEW_WIDTH + xx) * NUM_OBS_PLANES);
+				changed++;
+			}
+		}
+	}
+	else {
+		for (int p = 0; p < NUM_OBS_PLANES; p++) {
+			if (incremental) { // most planes are unchanged from tick to tick, and a branch-free pass over one finds that quickly
+				unsigned int any = 0;
+				for (int r = 0; r < VIEW_HEIGHT; r++) any |= rows[p][r] ^ written[p][r];
+				if (any == 0) continue;
+			}
+			T* plane = out + p * VIEW_HEIGHT * VIEW_WIDTH;
+			for (int r = 0; r < VIEW_HEIGHT; r++) {
+				if (incremental && rows[p][r] == written[p][r]) continue;
+				expandBits(rows[p][r], VIEW_WIDTH, plane + r * VIEW_WIDTH);
+				changed++;
+			}
+		}
+	}
+	m_gathered = 1 - m_gathered; // what was gathered is now what the buffer holds
+	m_writtenOut = out;
+	m_writtenLayout = layout;
+	m_writtenElementSize = sizeof(T);
+	m_lastChanged = changed;
+
+	const Player* player = sw.getPlayer();
+	T* scalars = out + NUM_OBS_PLANES * VIEW_HEIGHT * VIEW_WIDTH;
+	setScalar(scalars[OBS_SCALAR_LIVES], sw.getLives());
+	setScalar(scalars[OBS_SCALAR_BURPS], player != nullptr ? player->getBurps() : 0);
+	setScalar(scalars[OBS_SCALAR_FREEZE], player != nullptr ? player->getFreezeTicks() : 0);
+	setScalar(scalars[OBS_SCALAR_JUMP], player != nullptr ? player->getJumpTicks() : 0);
+}
@@ -0,0 +1,75 @@
+#ifndef OBSERVATIONENCODER_H_
+#define OBSERVATIONENCODER_H_
+
+#include "GameConstants.h"
+#include "Bitboard.h"
+#include <cstddef>
+#include <cstdint>
+
+class StudentWorld;
+
+// Planes of an encoded observation, one per kind of thing on the board. A square is 1 in a plane if that
+// kind of thing is on it, and 0 otherwise
+const int OBS_PLANE_FLOOR = 0;
+const int OBS_PLANE_LADDER = 1;
+const int OBS_PLANE_PLAYER = 2;
+const int OBS_PLANE_BARREL = 3;
+const int OBS_PLANE_FIREBALL = 4;
+const int OBS_PLANE_KOOPA = 5;
+const int OBS_PLANE_HUNTER = 6;
+const int OBS_PLANE_BONFIRE = 7;
+const int OBS_PLANE_GARLIC = 8;
+const int OBS_PLANE_EXTRA_LIFE = 9;
+const int OBS_PLANE_BURP = 10;
+const int OBS_PLANE_KONG = 11;
+const int NUM_OBS_PLANES = 12;
+
+// Scalar features, which follow the planes. Raw counts, clamped to 255 in a uint8_t observation
+const int OBS_SCALAR_LIVES = 0;
+const int OBS_SCALAR_BURPS = 1;
+const int OBS_SCALAR_FREEZE = 2; // ticks the player has left frozen
+const int OBS_SCALAR_JUMP = 3; // substeps left in the player's jump. 0 when not jumping
+const int NUM_OBS_SCALARS = 4;
+
+// Element orders of the planes. Rows run top row first in both, as the board is drawn
+const int OBS_LAYOUT_NCHW = 0; // plane by plane: element (p * VIEW_HEIGHT + row) * VIEW_WIDTH + col
+const int OBS_LAYOUT_NHWC = 1; // square by square, each square's planes together: element (row * VIEW_WIDTH + col) * NUM_OBS_PLANES + p
+
+const size_t OBS_SIZE = NUM_OBS_PLANES * VIEW_WIDTH * VIEW_HEIGHT + NUM_OBS_SCALARS; // elements per world, in either layout
+
+// Writes a StudentWorld's board as stacked one-hot planes plus scalar features, straight into a buffer the
+// caller owns, such as one world's slice of a training batch. The board is gathered into a bit mask per
+// plane row, and per square, and then expanded into the buffer by table lookups that turn eight bits into
+// eight bytes (or four into four floats) with a single copy.
+//
+// update() rewrites only the plane rows (NCHW) or squares (NHWC) that changed since this encoder last
+// wrote the same buffer, which on a typical tick is a handful of actors' old and new squares. Keep one
+// encoder per world and buffer. Nothing allocates.
+class ObservationEncoder {
+public:
+	ObservationEncoder();
+	void encode(const StudentWorld& sw, int layout, uint8_t* out); // writes all OBS_SIZE elements of out
+	void encode(const StudentWorld& sw, int layout, float* out);
+	void update(const StudentWorld& sw, int layout, uint8_t* out); // the same result as encode(), provided out still holds what this encoder last wrote to it
+	void update(const StudentWorld& sw, int layout, float* out);
+	void invalidate(); // makes the next update() write everything, for when something else has written the buffer
+	int lastChanged() const; // plane rows (NCHW) or squares (NHWC) rewritten by the last call
+private:
+	typedef uint16_t CellMask; // bit p set if the square is in plane p
+	unsigned int m_rows[2][NUM_OBS_PLANES][VIEW_HEIGHT]; // the board by output row, bit col of a row being that square. Alternately as gathered and as last written, so neither is copied to the other
+	int m_gathered; // which of m_rows gather() fills. The other is what the buffer last written holds
+	CellMask m_cells[VIEW_HEIGHT][VIEW_WIDTH]; // the gathered squares, by output row. Only gathered for NHWC
+	Bitboard m_floors; // terrain the rows and cells below were built from
+	Bitboard m_ladders;
+	unsigned int m_terrainRows[2][VIEW_HEIGHT]; // floor and ladder rows of m_terrainCells
+	CellMask m_terrainCells[VIEW_HEIGHT][VIEW_WIDTH]; // floors and ladders, rebuilt only when the level's terrain changes
+	const void* m_writtenOut; // buffer last written, or null if none is known to be up to date
+	int m_writtenLayout;
+	size_t m_writtenElementSize;
+	int m_lastChanged;
+	void gather(const StudentWorld& sw, bool cells); // fills m_rows[m_gathered], and m_cells if cells is set, from sw
+	template <typename T>
+	void write(const StudentWorld& sw, int layout, T* out, bool incremental);
+};
+
+#endif // OBSERVATIONENCODER_H_
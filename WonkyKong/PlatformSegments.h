@@ -0,0 +1,51 @@
+#ifndef PLATFORMSEGMENTS_H_
+#define PLATFORMSEGMENTS_H_
+
+#include "GameConstants.h"
+#include "Bitboard.h"
+
+// Patrol segments of a level's platforms, worked out once per level since floors and ladders never move.
+// A segment is a horizontal run of walkable squares (see TerrainBitboards::walkable), which is exactly the
+// stretch an enemy patrols before it turns around at a wall or a cliff. For every square, the table holds
+// the ends of the segment reachable from it, so a patrol step is a bounds check.
+class PlatformSegments {
+public:
+	PlatformSegments();
+	void build(const Bitboard& walkable); // recomputes the table for a level
+	int leftEnd(int xx, int yy) const; // smallest x an enemy at (xx, yy) reaches by walking left. xx itself if it cannot step left
+	int rightEnd(int xx, int yy) const; // largest x reached by walking right
+	bool canStep(int xx, int yy, int dx) const; // true if an enemy at (xx, yy) can take one step of dx (-1 or 1) without meeting a wall or cliff
+private:
+	signed char m_leftEnd[VIEW_HEIGHT][VIEW_WIDTH];
+	signed char m_rightEnd[VIEW_HEIGHT][VIEW_WIDTH];
+};
+
+inline PlatformSegments::PlatformSegments() {
+	build(Bitboard());
+}
+
+inline void PlatformSegments::build(const Bitboard& walkable) {
+	for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+		// Only the squares stepped onto have to be walkable, not the one the enemy starts from
+		for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+			m_leftEnd[yy][xx] = static_cast<signed char>(walkable.test(xx - 1, yy) ? m_leftEnd[yy][xx - 1] : xx);
+		}
+		for (int xx = VIEW_WIDTH - 1; xx >= 0; xx--) {
+			m_rightEnd[yy][xx] = static_cast<signed char>(walkable.test(xx + 1, yy) ? m_rightEnd[yy][xx + 1] : xx);
+		}
+	}
+}
+
+inline int PlatformSegments::leftEnd(int xx, int yy) const {
+	return m_leftEnd[yy][xx];
+}
+
+inline int PlatformSegments::rightEnd(int xx, int yy) const {
+	return m_rightEnd[yy][xx];
+}
+
+inline bool PlatformSegments::canStep(int xx, int yy, int dx) const {
+	return dx < 0 ? xx > m_leftEnd[yy][xx] : xx < m_rightEnd[yy][xx];
+}
+
+#endif // PLATFORMSEGMENTS_H_
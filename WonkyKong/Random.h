@@ -0,0 +1,87 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+// Seedable pseudo-random generator (xoshiro256**) with cheap bounded sampling. Each StudentWorld owns one,
+// so a game can be replayed from its seed and worlds never share generator state. stream() derives an
+// independent generator for an actor or subsystem from the seed alone, so what one stream draws never
+// depends on how much another has been used.
+class Random {
+public:
+	explicit Random(uint64_t seed = 0);
+	void seed(uint64_t seed); // restarts the sequence for seed
+	uint64_t seedValue() const { return m_seed; } // the seed the current sequence started from
+	uint64_t next(); // 64 uniformly distributed bits
+	int intIn(int min, int max); // uniformly distributed int from min to max, inclusive
+	bool oneIn(int n); // true with probability 1/n
+	Random stream(uint64_t id) const; // generator for stream id of this seed. Doesn't advance this generator
+	Random split(); // generator seeded from this one's next output, for handing off a stream of its own
+private:
+	uint64_t m_state[4];
+	uint64_t m_seed;
+	static uint64_t splitMix(uint64_t& x); // expands a seed into well-mixed state words
+	static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+inline Random::Random(uint64_t seed) {
+	this->seed(seed);
+}
+
+inline void Random::seed(uint64_t seed) {
+	m_seed = seed;
+	uint64_t x = seed;
+	for (int i = 0; i < 4; i++) m_state[i] = splitMix(x); // never all zero, which xoshiro can't leave
+}
+
+inline uint64_t Random::next() {
+	uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+	uint64_t t = m_state[1] << 17;
+	m_state[2] ^= m_state[0];
+	m_state[3] ^= m_state[1];
+	m_state[1] ^= m_state[2];
+	m_state[0] ^= m_state[3];
+	m_state[2] ^= t;
+	m_state[3] = rotl(m_state[3], 45);
+	return result;
+}
+
+inline int Random::intIn(int min, int max) {
+	if (max < min) {
+		int t = min;
+		min = max;
+		max = t;
+	}
+	// Multiply-and-shift maps 32 random bits onto the range without a division. The rare low products
+	// that would make some values more likely than others are rejected and drawn again
+	uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min) + 1;
+	if (range == 0) return static_cast<int>(static_cast<uint32_t>(next() >> 32)); // the whole int range
+	uint64_t m = (next() >> 32) * range;
+	if (static_cast<uint32_t>(m) < range) {
+		uint32_t threshold = static_cast<uint32_t>(-range) % range;
+		while (static_cast<uint32_t>(m) < threshold) m = (next() >> 32) * range;
+	}
+	return static_cast<int>(static_cast<int64_t>(min) + static_cast<int64_t>(m >> 32));
+}
+
+inline bool Random::oneIn(int n) {
+	return intIn(0, n - 1) == 0;
+}
+
+inline Random Random::stream(uint64_t id) const {
+	uint64_t x = m_seed ^ (id * 0xD1B54A32D192ED03ull); // odd multiplier, so distinct ids give distinct seeds
+	return Random(splitMix(x));
+}
+
+inline Random Random::split() {
+	return Random(next());
+}
+
+inline uint64_t Random::splitMix(uint64_t& x) {
+	uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+#endif // RANDOM_H_
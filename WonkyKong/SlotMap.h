@@ -0,0 +1,133 @@
+#ifndef SLOTMAP_H_
+#define SLOTMAP_H_
+
+#include <vector>
+#include <cstddef>
+
+// Reference to an element of a SlotMap. A handle stays valid until its element is erased;
+// after that, the slot's generation no longer matches, even if the slot has been reused.
+struct SlotHandle {
+	unsigned int index; // slot index, stable for the lifetime of the element
+	unsigned int generation; // bumped every time the slot is freed
+	bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+const SlotHandle INVALID_SLOT_HANDLE = { 0xFFFFFFFFu, 0 };
+
+// Values are stored densely in insertion order for iteration. Each handle refers to a slot, and each slot
+// records where its value currently sits in the dense array, so lookups and liveness checks are O(1).
+template <typename T>
+class SlotMap {
+public:
+	SlotHandle insert(const T& value); // appends value to the dense array and returns its handle
+	bool contains(SlotHandle h) const; // true if h refers to an element that has not been erased
+	T* get(SlotHandle h); // pointer to the element for h, or nullptr if it has been erased
+	const T* get(SlotHandle h) const;
+	template <typename Pred>
+	void eraseIf(Pred shouldErase); // erases elements for which shouldErase(value) is true in one stable pass. shouldErase is called exactly once per element, in order
+	void clear(); // erases all elements, invalidating every outstanding handle
+	void reserve(size_t n); // room for n elements and their slots, so inserting up to n doesn't allocate
+	size_t size() const { return m_dense.size(); }
+	bool empty() const { return m_dense.empty(); }
+	T& operator[](size_t i) { return m_dense[i]; } // i-th element in dense (insertion) order
+	const T& operator[](size_t i) const { return m_dense[i]; }
+	SlotHandle handleAt(size_t i) const; // handle of the i-th element in dense order
+private:
+	struct Slot {
+		unsigned int denseIndex; // position of the element in m_dense while the slot is in use
+		unsigned int generation;
+	};
+	std::vector<T> m_dense; // elements, packed
+	std::vector<unsigned int> m_denseToSlot; // slot index of each element in m_dense
+	std::vector<Slot> m_slots;
+	std::vector<unsigned int> m_freeSlots; // slots available for reuse
+	void freeSlot(unsigned int slot); // invalidates handles to slot and makes it available for reuse
+};
+
+template <typename T>
+SlotHandle SlotMap<T>::insert(const T& value) {
+	unsigned int slot;
+	if (!m_freeSlots.empty()) {
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		slot = static_cast<unsigned int>(m_slots.size());
+		Slot s = { 0, 0 };
+		m_slots.push_back(s);
+	}
+	m_slots[slot].denseIndex = static_cast<unsigned int>(m_dense.size());
+	m_dense.push_back(value);
+	m_denseToSlot.push_back(slot);
+	SlotHandle h = { slot, m_slots[slot].generation };
+	return h;
+}
+
+template <typename T>
+bool SlotMap<T>::contains(SlotHandle h) const {
+	return h.index < m_slots.size() && m_slots[h.index].generation == h.generation;
+}
+
+template <typename T>
+T* SlotMap<T>::get(SlotHandle h) {
+	if (!contains(h)) return nullptr;
+	return &m_dense[m_slots[h.index].denseIndex];
+}
+
+template <typename T>
+const T* SlotMap<T>::get(SlotHandle h) const {
+	if (!contains(h)) return nullptr;
+	return &m_dense[m_slots[h.index].denseIndex];
+}
+
+template <typename T>
+SlotHandle SlotMap<T>::handleAt(size_t i) const {
+	unsigned int slot = m_denseToSlot[i];
+	SlotHandle h = { slot, m_slots[slot].generation };
+	return h;
+}
+
+template <typename T>
+template <typename Pred>
+void SlotMap<T>::eraseIf(Pred shouldErase) {
+	size_t nKept = 0;
+	for (size_t i = 0; i < m_dense.size(); i++) {
+		unsigned int slot = m_denseToSlot[i];
+		if (shouldErase(m_dense[i])) {
+			freeSlot(slot);
+			continue;
+		}
+		if (nKept != i) {
+			m_dense[nKept] = m_dense[i];
+			m_denseToSlot[nKept] = slot;
+		}
+		m_slots[slot].denseIndex = static_cast<unsigned int>(nKept);
+		nKept++;
+	}
+	m_dense.resize(nKept);
+	m_denseToSlot.resize(nKept);
+}
+
+template <typename T>
+void SlotMap<T>::clear() {
+	for (size_t i = 0; i < m_denseToSlot.size(); i++) freeSlot(m_denseToSlot[i]);
+	m_dense.clear();
+	m_denseToSlot.clear();
+}
+
+template <typename T>
+void SlotMap<T>::reserve(size_t n) {
+	m_dense.reserve(n);
+	m_denseToSlot.reserve(n);
+	m_slots.reserve(n);
+	m_freeSlots.reserve(n);
+}
+
+template <typename T>
+void SlotMap<T>::freeSlot(unsigned int slot) {
+	m_slots[slot].generation++; // any handle still holding the old generation is now stale
+	m_freeSlots.push_back(slot);
+}
+
+#endif // SLOTMAP_H_
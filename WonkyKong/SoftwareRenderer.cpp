@@ -0,0 +1,396 @@
+#include "SoftwareRenderer.h"
+#include "GameWorld.h"
+#include "GraphObject.h"
+#include "SpriteInfo.h"
+#include "TgaImage.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(_DEBUG)
+#include <cassert>
+#endif
+
+namespace {
+	const int NUM_DEPTHS = 4; // as GraphObject draws them, 3 first and 0 last
+	const int FACING_RIGHT = 0; // the order of each frame's sprites in CellSprites
+	const int FACING_LEFT = 1;
+	const int FACING_UP = 2;
+	const int FACING_DOWN = 3;
+	const int NUM_FACINGS = 4;
+	const uint32_t OPAQUE_BLACK = 0xff000000u; // the GL clear colour
+
+	inline uint32_t pack(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	// x / 255, rounded, for x up to 255 * 255 + 255. Exact, and what the SSE2 lanes compute too
+	inline uint32_t div255(uint32_t x) {
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	// src over dst, both premultiplied
+	inline uint32_t blendPixel(uint32_t src, uint32_t dst) {
+		uint32_t inverse = 255 - (src >> 24);
+		uint32_t out = 0;
+		for (int shift = 0; shift < 32; shift += 8) {
+			out |= (((src >> shift) & 0xff) + div255(((dst >> shift) & 0xff) * inverse)) << shift; // a premultiplied channel is at most its alpha, so the sum can't pass 255
+		}
+		return out;
+	}
+
+	void blendScalar(uint32_t* dst, const uint32_t* src, int n) {
+		for (int i = 0; i < n; i++) {
+			uint32_t a = src[i] >> 24;
+			if (a == 255) dst[i] = src[i];
+			else if (a != 0) dst[i] = blendPixel(src[i], dst[i]); // a transparent pixel is all zeros, so it leaves dst as it is
+		}
+	}
+
+	void blendRow(uint32_t* dst, const uint32_t* src, int n) {
+		int i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+#if defined(_DEBUG)
+		uint32_t reference[VIEW_WIDTH * 64]; // debug builds check the vector lanes against the scalar path
+		int checked = std::min(n, static_cast<int>(sizeof(reference) / sizeof(reference[0])));
+		std::memcpy(reference, dst, checked * sizeof(uint32_t));
+		blendScalar(reference, src, checked);
+#endif
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i opaque = _mm_set1_epi32(static_cast<int>(OPAQUE_BLACK));
+		const __m128i max = _mm_set1_epi16(255);
+		const __m128i half = _mm_set1_epi16(128);
+		for (; i + 4 <= n; i += 4) { // four pixels, one 16-bit lane per channel
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff) continue; // all transparent, as most of a sprite's edges are
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, opaque), opaque)) == 0xffff) { // all opaque
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+				continue;
+			}
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+			__m128i sLo = _mm_unpacklo_epi8(s, zero);
+			__m128i sHi = _mm_unpackhi_epi8(s, zero);
+			__m128i inverseLo = _mm_sub_epi16(max, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+			__m128i inverseHi = _mm_sub_epi16(max, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverseLo), half); // at most 255 * 255 + 128, so unsigned 16 bits hold it
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverseHi), half);
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_add_epi16(sLo, lo), _mm_add_epi16(sHi, hi)));
+		}
+#endif
+		blendScalar(dst + i, src + i, n - i); // the pixels left over, or every pixel without SSE2
+#if (defined(__SSE2__) || defined(_M_X64)) && defined(_DEBUG)
+		assert(std::memcmp(reference, dst, checked * sizeof(uint32_t)) == 0);
+#endif
+	}
+
+	// a * (256 - weight) + b * weight for each byte of n pixels, which can't pass 255 * 256
+	void lerpRows(const uint32_t* a, const uint32_t* b, int weight, uint16_t* out, int n) {
+		int i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i wa = _mm_set1_epi16(static_cast<short>(256 - weight));
+		const __m128i wb = _mm_set1_epi16(static_cast<short>(weight));
+		for (; i + 4 <= n; i += 4) {
+			__m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			__m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pa, zero), wa), _mm_mullo_epi16(_mm_unpacklo_epi8(pb, zero), wb));
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pa, zero), wa), _mm_mullo_epi16(_mm_unpackhi_epi8(pb, zero), wb));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i), lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i + 8), hi);
+		}
+#endif
+		for (; i < n; i++) {
+			for (int k = 0; k < 4; k++) {
+				out[4 * i + k] = static_cast<uint16_t>(((a[i] >> (8 * k)) & 0xff) * (256 - weight) + ((b[i] >> (8 * k)) & 0xff) * weight);
+			}
+		}
+	}
+
+	inline uint8_t luma(uint32_t r, uint32_t g, uint32_t b) {
+		return static_cast<uint8_t>((77 * r + 150 * g + 29 * b + 128) >> 8);
+	}
+
+	// Where output pixel o of n samples a row of size pixels. Nearest takes the pixel under the output
+	// pixel's centre; bilinear the pixel before the centre and the weight of the one after
+	void sampleTable(int n, int size, int filter, std::vector<int>& index, std::vector<uint16_t>& weight) {
+		index.resize(n);
+		weight.assign(n, 0);
+		for (int o = 0; o < n; o++) {
+			if (filter == FILTER_NEAREST) {
+				index[o] = static_cast<int>((2 * static_cast<long long>(o) + 1) * size / (2 * n));
+				continue;
+			}
+			double centre = (o + 0.5) * size / n - 0.5;
+			if (centre < 0) centre = 0;
+			int first = static_cast<int>(centre);
+			if (first >= size - 1) {
+				first = size - 1;
+				centre = first;
+			}
+			index[o] = first;
+			weight[o] = static_cast<uint16_t>((centre - first) * 256 + 0.5);
+		}
+	}
+
+	// Scales a sprite to cell x cell, by sampling or by averaging the pixels under each output pixel
+	void scaleSprite(int width, int height, const uint32_t* pixels, int cell, int filter, uint32_t* out) {
+		for (int j = 0; j < cell; j++) {
+			int top = j * height / cell;
+			int bottom = std::max(top + 1, (j + 1) * height / cell);
+			for (int i = 0; i < cell; i++) {
+				if (filter == FILTER_NEAREST) {
+					out[j * cell + i] = pixels[((2 * j + 1) * height / (2 * cell)) * width + (2 * i + 1) * width / (2 * cell)];
+					continue;
+				}
+				int left = i * width / cell;
+				int right = std::max(left + 1, (i + 1) * width / cell);
+				uint32_t sums[4] = { 0, 0, 0, 0 };
+				for (int y = top; y < bottom; y++) {
+					for (int x = left; x < right; x++) {
+						uint32_t p = pixels[y * width + x];
+						for (int k = 0; k < 4; k++) sums[k] += (p >> (8 * k)) & 0xff;
+					}
+				}
+				uint32_t count = (bottom - top) * (right - left);
+				out[j * cell + i] = pack((sums[0] + count / 2) / count, (sums[1] + count / 2) / count, (sums[2] + count / 2) / count, (sums[3] + count / 2) / count);
+			}
+		}
+	}
+
+	int facingOf(int direction) { // a tile's none, like right, is drawn as it is
+		switch (direction) {
+		case GraphObject::left: return FACING_LEFT;
+		case GraphObject::up: return FACING_UP;
+		case GraphObject::down: return FACING_DOWN;
+		default: return FACING_RIGHT;
+		}
+	}
+}
+
+bool SpriteSheet::load(const std::string& assetPath) {
+	m_sprites.clear();
+	m_depths.clear();
+	m_scaled.clear();
+	for (const SpriteInfo& info : SPRITES) {
+		TgaImage image;
+		if (!image.load(assetPath + info.tgaFileName)) return false;
+		if (info.imageID >= m_sprites.size()) {
+			m_sprites.resize(info.imageID + 1);
+			m_depths.resize(info.imageID + 1, 0);
+		}
+		std::vector<Sprite>& frames = m_sprites[info.imageID];
+		if (info.frameNum >= frames.size()) frames.resize(info.frameNum + 1);
+		m_depths[info.imageID] = info.depth;
+
+		Sprite& sprite = frames[info.frameNum];
+		sprite.width = image.width;
+		sprite.height = image.height;
+		sprite.pixels.resize(static_cast<size_t>(image.width) * image.height);
+		for (int y = 0; y < image.height; y++) {
+			const unsigned char* row = reinterpret_cast<const unsigned char*>(image.pixels.data()) + static_cast<size_t>(image.height - 1 - y) * image.width * image.bytesPerPixel; // the file's rows run bottom first
+			for (int x = 0; x < image.width; x++) {
+				const unsigned char* p = row + x * image.bytesPerPixel;
+				uint32_t a = image.bytesPerPixel == 4 ? p[3] : 255;
+				sprite.pixels[y * image.width + x] = pack(div255(p[2] * a), div255(p[1] * a), div255(p[0] * a), a);
+			}
+		}
+	}
+	return true;
+}
+
+const CellSprites& SpriteSheet::scaled(int cell, int filter) {
+	std::unique_ptr<CellSprites>& entry = m_scaled[std::make_pair(cell, filter)];
+	if (entry) return *entry;
+	entry.reset(new CellSprites);
+	CellSprites& scaled = *entry;
+	scaled.cell = cell;
+	scaled.firstSprite.assign(m_sprites.size(), -1);
+	scaled.frames.assign(m_sprites.size(), 0);
+	scaled.depths = m_depths;
+	int sprites = 0;
+	for (size_t id = 0; id < m_sprites.size(); id++) {
+		if (m_sprites[id].empty()) continue;
+		scaled.firstSprite[id] = sprites;
+		scaled.frames[id] = static_cast<int>(m_sprites[id].size());
+		sprites += scaled.frames[id] * NUM_FACINGS;
+	}
+
+	const size_t area = static_cast<size_t>(cell) * cell;
+	scaled.pixels.assign(sprites * area, 0);
+	std::vector<uint32_t> base(area);
+	for (size_t id = 0; id < m_sprites.size(); id++) {
+		for (size_t f = 0; f < m_sprites[id].size(); f++) {
+			const Sprite& sprite = m_sprites[id][f];
+			if (sprite.pixels.empty()) continue; // a frame SPRITES skips, left transparent
+			scaleSprite(sprite.width, sprite.height, sprite.pixels.data(), cell, filter, base.data());
+			uint32_t* out = &scaled.pixels[(scaled.firstSprite[id] + f * NUM_FACINGS) * area];
+			for (int j = 0; j < cell; j++) { // the turns SpriteManager::plotSprite gives each direction
+				for (int i = 0; i < cell; i++) {
+					out[FACING_RIGHT * area + j * cell + i] = base[j * cell + i];
+					out[FACING_LEFT * area + j * cell + i] = base[j * cell + cell - 1 - i]; // mirrored, not upside down
+					out[FACING_UP * area + j * cell + i] = base[i * cell + cell - 1 - j]; // a quarter turn anticlockwise
+					out[FACING_DOWN * area + j * cell + i] = base[(cell - 1 - i) * cell + j]; // and clockwise
+				}
+			}
+		}
+	}
+	return scaled;
+}
+
+SoftwareRenderer::SoftwareRenderer(SpriteSheet& sprites, int width, int height, int channels, int filter)
+	: m_width(width > 0 ? width : 1), m_height(height > 0 ? height : 1), m_channels(channels == PIXELS_GREY ? PIXELS_GREY : PIXELS_RGBA),
+	  m_filter(filter == FILTER_BILINEAR ? FILTER_BILINEAR : FILTER_NEAREST), m_haveBackground(false) {
+	m_cell = cellSize(m_width, m_height);
+	m_canvasWidth = VIEW_WIDTH * m_cell;
+	m_canvasHeight = VIEW_HEIGHT * m_cell;
+	m_sprites = &sprites.scaled(m_cell, m_filter);
+	m_background.assign(static_cast<size_t>(m_canvasWidth) * m_canvasHeight, OPAQUE_BLACK);
+	m_canvas = m_background;
+	std::memset(m_tiles, 0, sizeof(m_tiles));
+	std::memset(m_covered, 0, sizeof(m_covered));
+	sampleTable(m_width, m_canvasWidth, m_filter, m_xs, m_xWeights);
+	sampleTable(m_height, m_canvasHeight, m_filter, m_ys, m_yWeights);
+	if (m_filter == FILTER_BILINEAR) m_rowBuffer.assign(4 * (m_canvasWidth + 1), 0);
+}
+
+int SoftwareRenderer::width() const {
+	return m_width;
+}
+
+int SoftwareRenderer::height() const {
+	return m_height;
+}
+
+int SoftwareRenderer::channels() const {
+	return m_channels;
+}
+
+int SoftwareRenderer::filter() const {
+	return m_filter;
+}
+
+int SoftwareRenderer::cellSize(int width, int height) {
+	int cell = std::max((width + VIEW_WIDTH - 1) / VIEW_WIDTH, (height + VIEW_HEIGHT - 1) / VIEW_HEIGHT);
+	return cell > 0 ? cell : 1;
+}
+
+void SoftwareRenderer::render(const GameWorld& world, uint8_t* out) {
+	// Terrain only changes with the level, so the background is recomposited only when a tile differs
+	bool terrainChanged = !m_haveBackground;
+	for (int y = 0; y < VIEW_HEIGHT; y++) {
+		for (int x = 0; x < VIEW_WIDTH; x++) {
+			int tile = world.getTileImageID(x, y);
+			if (tile != m_tiles[y][x]) terrainChanged = true;
+			m_tiles[y][x] = tile;
+		}
+	}
+	if (terrainChanged) {
+		std::fill(m_background.begin(), m_background.end(), OPAQUE_BLACK);
+		for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--) {
+			for (int y = 0; y < VIEW_HEIGHT; y++) {
+				for (int x = 0; x < VIEW_WIDTH; x++) {
+					int tile = m_tiles[y][x];
+					if (tile >= 0 && tile < static_cast<int>(m_sprites->depths.size()) && m_sprites->firstSprite[tile] >= 0 && m_sprites->depths[tile] == depth)
+						drawSprite(m_background, m_sprites->firstSprite[tile], x, y);
+				}
+			}
+		}
+		std::copy(m_background.begin(), m_background.end(), m_canvas.begin());
+		m_haveBackground = true;
+	}
+	else {
+		for (int y = 0; y < VIEW_HEIGHT; y++) {
+			for (unsigned int row = m_covered[y]; row != 0; row &= row - 1) {
+				int x = 0;
+				while (((row >> x) & 1) == 0) x++;
+				copySquare(m_background, m_canvas, x, y);
+			}
+		}
+	}
+	std::memset(m_covered, 0, sizeof(m_covered));
+
+	const std::vector<GraphObject*>& objects = world.graphObjects();
+	const int images = static_cast<int>(m_sprites->frames.size());
+	for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--) {
+		for (size_t i = 0; i < objects.size(); i++) {
+			const GraphObject* go = objects[i];
+			int image = go->getImageID();
+			int x = go->getX();
+			int y = go->getY();
+			if (!go->isVisible() || image < 0 || image >= images || m_sprites->frames[image] == 0 || m_sprites->depths[image] != depth) continue;
+			if (x < 0 || y < 0 || x >= VIEW_WIDTH || y >= VIEW_HEIGHT) continue;
+			int frame = static_cast<int>(go->getAnimationNumber() % m_sprites->frames[image]);
+			drawSprite(m_canvas, m_sprites->firstSprite[image] + frame * NUM_FACINGS + facingOf(go->getDirection()), x, y);
+			drawTile(x, y, depth);
+			m_covered[y] |= 1u << x;
+		}
+	}
+	resample(out);
+}
+
+void SoftwareRenderer::drawSprite(std::vector<uint32_t>& to, int sprite, int x, int y) {
+	const uint32_t* src = &m_sprites->pixels[static_cast<size_t>(sprite) * m_cell * m_cell];
+	uint32_t* dst = &to[static_cast<size_t>(VIEW_HEIGHT - 1 - y) * m_cell * m_canvasWidth + x * m_cell];
+	for (int row = 0; row < m_cell; row++) blendRow(dst + row * m_canvasWidth, src + row * m_cell, m_cell);
+}
+
+void SoftwareRenderer::drawTile(int x, int y, int aboveDepth) {
+	// GameController draws each depth's tiles before its objects, so a tile shallower than an object on
+	// its square covers it
+	int tile = m_tiles[y][x];
+	if (tile < 0 || tile >= static_cast<int>(m_sprites->depths.size()) || m_sprites->firstSprite[tile] < 0) return;
+	if (m_sprites->depths[tile] < aboveDepth) drawSprite(m_canvas, m_sprites->firstSprite[tile], x, y);
+}
+
+void SoftwareRenderer::copySquare(const std::vector<uint32_t>& from, std::vector<uint32_t>& to, int x, int y) {
+	size_t first = static_cast<size_t>(VIEW_HEIGHT - 1 - y) * m_cell * m_canvasWidth + x * m_cell;
+	for (int row = 0; row < m_cell; row++, first += m_canvasWidth) std::memcpy(&to[first], &from[first], m_cell * sizeof(uint32_t));
+}
+
+void SoftwareRenderer::resample(uint8_t* out) {
+	// With the canvas the frame's size, both filters sample each pixel where it is
+	bool nearest = m_filter == FILTER_NEAREST || (m_canvasWidth == m_width && m_canvasHeight == m_height);
+	for (int oy = 0; oy < m_height; oy++) {
+		uint8_t* o = out + static_cast<size_t>(oy) * m_width * m_channels;
+		if (nearest) {
+			const uint32_t* row = &m_canvas[static_cast<size_t>(m_ys[oy]) * m_canvasWidth];
+			if (m_channels == PIXELS_RGBA && m_width == m_canvasWidth) std::memcpy(o, row, m_width * sizeof(uint32_t));
+			else if (m_channels == PIXELS_RGBA) {
+				for (int ox = 0; ox < m_width; ox++) std::memcpy(o + 4 * ox, &row[m_xs[ox]], 4); // R is the lowest byte, so a little-endian store writes R, G, B, A
+			}
+			else {
+				for (int ox = 0; ox < m_width; ox++) {
+					uint32_t p = row[m_xs[ox]];
+					o[ox] = luma(p & 0xff, (p >> 8) & 0xff, (p >> 16) & 0xff);
+				}
+			}
+			continue;
+		}
+
+		int y0 = m_ys[oy];
+		int y1 = y0 + 1 < m_canvasHeight ? y0 + 1 : y0;
+		uint16_t* blended = m_rowBuffer.data();
+		lerpRows(&m_canvas[static_cast<size_t>(y0) * m_canvasWidth], &m_canvas[static_cast<size_t>(y1) * m_canvasWidth], m_yWeights[oy], blended, m_canvasWidth);
+		std::memcpy(blended + 4 * m_canvasWidth, blended + 4 * (m_canvasWidth - 1), 4 * sizeof(uint16_t)); // so the last column's neighbour is itself
+		for (int ox = 0; ox < m_width; ox++) {
+			const uint16_t* p = blended + 4 * m_xs[ox];
+			uint32_t wb = m_xWeights[ox];
+			uint32_t wa = 256 - wb;
+			uint32_t r = (p[0] * wa + p[4] * wb + 32768) >> 16;
+			uint32_t g = (p[1] * wa + p[5] * wb + 32768) >> 16;
+			uint32_t b = (p[2] * wa + p[6] * wb + 32768) >> 16;
+			if (m_channels == PIXELS_RGBA) {
+				o[4 * ox] = static_cast<uint8_t>(r);
+				o[4 * ox + 1] = static_cast<uint8_t>(g);
+				o[4 * ox + 2] = static_cast<uint8_t>(b);
+				o[4 * ox + 3] = 255;
+			}
+			else o[ox] = luma(r, g, b);
+		}
+	}
+}
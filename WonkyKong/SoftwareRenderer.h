@@ -0,0 +1,90 @@
+#ifndef SOFTWARERENDERER_H_
+#define SOFTWARERENDERER_H_
+
+#include "GameConstants.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class GameWorld;
+
+const int PIXELS_GREY = 1; // channels of a rendered frame: one luma byte per pixel
+const int PIXELS_RGBA = 4; // or R, G, B and A bytes, A always 255
+
+const int FILTER_NEAREST = 0; // how sprites and the board are scaled to the requested size
+const int FILTER_BILINEAR = 1; // sprites are area-averaged, as the GL mipmaps are, and the board is bilinearly resampled
+
+// Sprites scaled to one board square of cell x cell pixels, in each direction they are drawn facing.
+// Pixels are premultiplied RGBA, R in the lowest byte, top row first
+struct CellSprites {
+	int cell;
+	std::vector<uint32_t> pixels; // every image's frames, each as four cell x cell sprites: facing right, left, up and down
+	std::vector<int> firstSprite; // by imageID, the index in pixels / (cell * cell) of frame 0 facing right. -1 if the image has no frames
+	std::vector<int> frames; // by imageID
+	std::vector<int> depths; // by imageID, as SpriteInfo has them
+};
+
+// Every frame in SPRITES, read once from its TGA file the way SpriteManager reads it for OpenGL, and kept at
+// its native size. Renderers share one sheet, which scales the sprites for each square size once.
+class SpriteSheet {
+public:
+	bool load(const std::string& assetPath); // false, having said what went wrong on cerr, if a sprite can't be read
+	const CellSprites& scaled(int cell, int filter); // scaled on the first call for a size and filter. Not thread safe
+private:
+	struct Sprite {
+		int width;
+		int height;
+		std::vector<uint32_t> pixels; // premultiplied RGBA, top row first
+	};
+	std::vector<std::vector<Sprite>> m_sprites; // by imageID, then frame
+	std::vector<int> m_depths;
+	std::map<std::pair<int, int>, std::unique_ptr<CellSprites>> m_scaled; // by cell size and filter
+};
+
+// Draws a world the way GameController does, without OpenGL: the terrain tiles and then every visible
+// graph object, deepest first, each sprite stretched over its square and mirrored or rotated to the way it
+// faces. The status line along the top is left out, as it is drawn with GLUT's stroke font.
+//
+// The board is composited at a whole number of pixels per square, the smallest at least as large as the
+// requested size, and then scaled to that size. The terrain is composited once per level into a background,
+// and each frame only the squares objects covered last frame are restored from it before the objects are
+// blended over, four pixels at a time where SSE2 is available. Keep one renderer per world. Nothing
+// allocates after construction.
+class SoftwareRenderer {
+public:
+	SoftwareRenderer(SpriteSheet& sprites, int width, int height, int channels, int filter); // channels is PIXELS_GREY or PIXELS_RGBA
+	void render(const GameWorld& world, uint8_t* out); // writes width * height * channels bytes to out, top row first
+	int width() const;
+	int height() const;
+	int channels() const;
+	int filter() const;
+	static int cellSize(int width, int height); // pixels per square of the board composited for a frame of that size
+private:
+	const CellSprites* m_sprites;
+	int m_width;
+	int m_height;
+	int m_channels;
+	int m_filter;
+	int m_cell;
+	int m_canvasWidth; // the board in pixels, VIEW_WIDTH by VIEW_HEIGHT squares of m_cell
+	int m_canvasHeight;
+	std::vector<uint32_t> m_background; // the terrain alone
+	std::vector<uint32_t> m_canvas; // the board as last composited
+	int m_tiles[VIEW_HEIGHT][VIEW_WIDTH]; // tiles m_background was drawn from, by board y and x
+	bool m_haveBackground; // false until the first frame
+	unsigned int m_covered[VIEW_HEIGHT]; // squares objects were drawn over last frame, bit x of row y
+	std::vector<int> m_xs; // for each output column, the canvas column it is sampled from. For bilinear, the first of two
+	std::vector<int> m_ys; // the same for rows
+	std::vector<uint16_t> m_xWeights; // for bilinear, the weight of the second column or row, out of 256
+	std::vector<uint16_t> m_yWeights;
+	std::vector<uint16_t> m_rowBuffer; // for bilinear, two canvas rows blended, 256 times over, with the last pixel repeated
+	void drawSprite(std::vector<uint32_t>& to, int sprite, int x, int y); // blends sprite over the square at board (x, y)
+	void drawTile(int x, int y, int aboveDepth); // blends the square's tile over it if the tile is drawn after things at aboveDepth
+	void copySquare(const std::vector<uint32_t>& from, std::vector<uint32_t>& to, int x, int y);
+	void resample(uint8_t* out); // scales the canvas to the frame's size and channels
+};
+
+#endif // SOFTWARERENDERER_H_
@@ -0,0 +1,39 @@
+#ifndef SPRITEINFO_H_
+#define SPRITEINFO_H_
+
+#include "GameConstants.h"
+
+  // One frame of an image: the TGA file it is drawn from, and its depth. Depth 0 is drawn last, on top
+struct SpriteInfo
+{
+	unsigned int imageID;
+	unsigned int frameNum;
+	const char*  tgaFileName;
+	const char*  imageName;
+	int          depth;
+};
+
+  // Every frame of every image, for both GameController's OpenGL drawing and the software renderer
+const SpriteInfo SPRITES[] = {
+	{ IID_PLAYER, 0, "mario1.tga", "PLAYER", 0 },
+	{ IID_PLAYER, 1, "mario2.tga", "PLAYER", 0 },
+	{ IID_KONG, 0, "kong1.tga", "KONG", 0 },
+	{ IID_KONG, 1, "kong2.tga", "KONG", 0 },
+	{ IID_KONG, 2, "kong3.tga", "KONG", 0 },
+	{ IID_BARREL, 0, "barrel1.tga", "BARREL", 1 },
+	{ IID_BARREL, 1, "barrel2.tga", "BARREL", 1 },
+	{ IID_BARREL, 2, "barrel3.tga", "BARREL", 1 },
+	{ IID_FIREBALL, 0, "fire1.tga", "FIREBALL", 1 },
+	{ IID_KOOPA, 0, "koopa1.tga", "KOOPA", 0 },
+	{ IID_KOOPA, 1, "koopa2.tga", "KOOPA", 0 },
+	{ IID_FLOOR, 0, "wall.tga", "FLOOR", 2 },
+	{ IID_LADDER, 0, "ladder.tga", "LADDER", 3 },
+	{ IID_EXTRA_LIFE_GOODIE, 0, "extralife.tga", "EXTRA_LIFE_GOODIE", 2 },
+	{ IID_GARLIC_GOODIE, 0, "garlic.tga", "GARLIC_GOODIE", 2 },
+	{ IID_BONFIRE, 0, "bonfire1.tga", "BONFIRE", 3 },
+	{ IID_BONFIRE, 1, "bonfire2.tga", "BONFIRE", 3 },
+	{ IID_BURP, 0, "gascloud.tga", "BURP", 1 },
+	{ IID_HUNTER, 0, "fire1.tga", "HUNTER", 1 },
+};
+
+#endif // SPRITEINFO_H_
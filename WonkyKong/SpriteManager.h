@@ -17,6 +17,7 @@
 #endif
 
 #include "GameConstants.h"
+#include "TgaImage.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -50,51 +51,13 @@ public:
 
 		m_frameCountPerSprite[imageID]++;  // keep track of how many frames per sprite we loaded
 
-		std::string line;
-		std::string contents = "";
-		std::ifstream tgaFile(filename_tga, std::ios::in|std::ios::binary);
-
-		if (!tgaFile) {
-	  		std::cerr << "***** Unable to open " << filename_tga << std::endl;
+		TgaImage image;
+		if (!image.load(filename_tga))
 			return false;
-		}
-
-		TGA_HEADER header;
-		tgaFile.read((char *)&header,sizeof(header));
-		unsigned char byteCount = static_cast<unsigned char>(header.pixel_depth) / 8;
-		const long imageSize = header.width_pixels * header.height_pixels * byteCount;
-
-		unsigned int textureWidth = header.width_pixels;
-		unsigned int textureHeight = header.height_pixels;
-
-		std::unique_ptr<char[]> imageData(new char[imageSize]);
-		tgaFile.seekg(18);
-		  // Read image data
-		tgaFile.read(imageData.get(), imageSize);
-		if (!tgaFile)
-		{
-			std::cerr << "***** Unable to read " << imageSize << " (imageSize) bytes from file "
-					  << filename_tga << std::endl;
-			return false;
-		}
-
-		  // image type either 2 (color) or 3 (greyscale)
-		if (header.color_map_type != 0 || (header.image_type != 2 && header.image_type != 3))
-		{
-			std::cerr << "***** Bad color_map_type or image type in "
-					  << filename_tga << std::endl;
-			return false;
-		}
-  
-		if (byteCount != 3 && byteCount != 4)
-		{
-			std::cerr << "***** Bad byte count " << byteCount << " in "
-					  << filename_tga << std::endl;
-			return false;
-		}
-
-		if (header.image_descriptor & 0x20)  // image ios flipped vertically
-	  		flipVertical(imageData.get(),header.width_pixels,header.height_pixels,byteCount);
+		unsigned char byteCount = static_cast<unsigned char>(image.bytesPerPixel);
+		unsigned int textureWidth = image.width;
+		unsigned int textureHeight = image.height;
+		char* imageData = image.pixels.data();
 
 		// Transfer Texture To OpenGL
 
@@ -130,15 +93,15 @@ public:
 		{
 			  // build our texture mipmaps
 			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-			makeMipmaps(byteCount, textureWidth, textureHeight, imageData.get());
+			makeMipmaps(byteCount, textureWidth, textureHeight, imageData);
 		}
 		else
 		{
 			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
 			if (3 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, imageData.get());
+				glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, imageData);
 			else if (4 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, imageData.get());
+				glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, imageData);
 		}
 
 		m_imageMap[spriteID] = glTextureID;
@@ -266,23 +229,6 @@ public:
 
 private:
 
-#pragma pack(1)
-  struct TGA_HEADER {
-	unsigned char id_length;
-	unsigned char color_map_type;
-	unsigned char image_type;
-	unsigned short index_of_first_color_map_entry;
-	unsigned short color_map_length;
-	unsigned char color_map_entry_size;
-	unsigned short x_origin;
-	unsigned short y_origin;
-	unsigned short width_pixels;
-	unsigned short height_pixels;
-	unsigned char pixel_depth;
-	unsigned char image_descriptor; // bits 3-0 give alpha channel depth, and 5-4 give direction.
-  };
-#pragma pack()
-
 	bool                  m_mipMapped;
 	std::map<int, GLuint> m_imageMap;
 	std::map<int, int>    m_frameCountPerSprite;
@@ -298,15 +244,6 @@ private:
 		yout = y * cos(theta) + x * sin(theta);
 	}
   
-	void flipVertical(char* image, int width, int height, int bytes_per_pixel)
-	{
-		int bytes_per_row = width * bytes_per_pixel;
-		for (int i = 0; i < height/2; i++)
-			std::swap_ranges(image + i * bytes_per_row,
-			                 image + (i+1) * bytes_per_row,
-							 image + (height-i-1) * bytes_per_row);
-	}
-
 	int getSpriteID(int imageID, int frame) const
 	{
 		if (imageID >= MAX_IMAGES || frame >= MAX_FRAMES_PER_SPRITE)
@@ -3,16 +3,23 @@
 #include "GraphObject.h"
 #include "Actor.h"
 #include "Level.h"
+#include "GameHost.h"
 #include <string>
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <utility>
+#include <random>
 using namespace std;
 
 string num2string(int x, int digits);
 bool checkIndex(int xx, int yy);
 
+const size_t LARGEST_ACTOR_SIZE = max({ sizeof(Player), sizeof(Burp), sizeof(Bonfire), sizeof(Fireball), sizeof(Koopa), sizeof(Hunter),
+    sizeof(Barrel), sizeof(ExtraLifeGoodie), sizeof(GarlicGoodie), sizeof(Kong) }); // what the level arena reserves room for, per actor
+
 GameWorld* createStudentWorld(string assetPath)
 {
     return new StudentWorld(assetPath);
@@ -21,8 +28,19 @@ GameWorld* createStudentWorld(string assetPath)
 // Students:  Add code to this file, StudentWorld.h, Actor.h, and Actor.cpp
 
 StudentWorld::StudentWorld(string assetPath)
-: GameWorld(assetPath), m_level(nullptr), m_player(nullptr), m_levelComplete(false)
+: GameWorld(assetPath), m_barrelPool(this, m_arena, BARREL_POOL_CAPACITY), m_burpPool(this, m_arena, BURP_POOL_CAPACITY),
+  m_garlicPool(this, m_arena, GOODIE_POOL_CAPACITY), m_extraLifePool(this, m_arena, GOODIE_POOL_CAPACITY),
+  m_player(nullptr), m_level(nullptr), m_levelCount(-1), m_random(random_device()()), m_tick(0), m_activeActors(0), m_peakActiveActors(0), m_activeActorTicks(0),
+  m_worldActorTicks(0), m_levelComplete(false), m_diagnostics(true), m_stepKey(INVALID_KEY), m_hasStepKey(false),
+  m_batchBarrels(true)
 {
+    for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+        for (int xx = 0; xx < VIEW_WIDTH; xx++) m_cellActors[yy][xx].reserve(CELL_BUCKET_CAPACITY); // so moving actors don't allocate
+    }
+    m_barrelBatch.reserve(BARREL_POOL_CAPACITY);
+    m_contactCandidates.reserve(CELL_BUCKET_CAPACITY * 2);
+    m_contactEvents.reserve(CELL_BUCKET_CAPACITY * 2);
+    m_statText.reserve(GAME_STAT_TEXT_CAPACITY);
 }
 
 StudentWorld::~StudentWorld() {
@@ -32,8 +50,16 @@ StudentWorld::~StudentWorld() {
 int StudentWorld::init()
 {
     m_levelComplete = false; // resets with every init
-    int loadResult = loadLevel();
+    m_tick = 0;
+    m_activeActors = 0;
+    m_peakActiveActors = 0;
+    m_activeActorTicks = 0;
+    m_worldActorTicks = 0;
+    for (int i = 0; i < 4; i++) m_displayedStats[i] = -1; // forces the game stats text to be rebuilt
+    if (m_levels.empty()) reserveForLevels(); // the first init() of a world
+    int loadResult = loadLevel(getLevel());
     if (loadResult != GWSTATUS_CONTINUE_GAME) return loadResult; // depends on whether there are any errors with file loading, or win condition reached
+    m_level = m_levels[getLevel()].get();
 
     // create Actors based on level file
     for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
@@ -41,149 +67,504 @@ int StudentWorld::init()
             // uses the Level class to get item at xx, yy
             // (0,0) is bottom left corner
             Level::MazeEntry me = m_level->getContentsOf(xx, yy);
+            // floors and ladders never move, so they live only in the terrain grid rather than m_actors.
+            // The framework draws them through getTileImageID()
+            m_terrain[yy][xx] = (me == Level::floor || me == Level::ladder) ? me : Level::empty;
             switch (me) {
-            case Level::floor:
-                m_actors.push_back(new Floor(this, xx, yy));
-                break;
-            case Level::ladder:
-                m_actors.push_back(new Ladder(this, xx, yy));
-                break;
             case Level::bonfire:
-                m_actors.push_back(new Bonfire(this, xx, yy));
+                createActor(m_bonfires, xx, yy);
                 break;
             case Level::extra_life:
-                m_actors.push_back(new ExtraLifeGoodie(this, xx, yy));
+                dropExtraLife(xx, yy);
                 break;
             case Level::garlic:
-                m_actors.push_back(new GarlicGoodie(this, xx, yy));
+                dropGarlic(xx, yy);
                 break;
             case Level::fireball:
-                m_actors.push_back(new Fireball(this, xx, yy));
+                createActor(m_fireballs, xx, yy);
                 break;
             case Level::koopa:
-                m_actors.push_back(new Koopa(this, xx, yy));
+                createActor(m_koopas, xx, yy);
+                break;
+            case Level::hunter:
+                createActor(m_hunters, xx, yy);
                 break;
             case Level::left_kong:
-                m_actors.push_back(new Kong(this, xx, yy, GraphObject::left));
+                createActor(m_kongs, xx, yy, GraphObject::left);
                 break;
             case Level::right_kong:
-                m_actors.push_back(new Kong(this, xx, yy, GraphObject::right));
+                createActor(m_kongs, xx, yy, GraphObject::right);
                 break;
-            case Level::player:
-                m_player = new Player(this, xx, yy, GraphObject::right); // player faces right initially
+            case Level::player: {
+                m_player = m_arena.create<Player>(this, xx, yy, GraphObject::right); // player faces right initially
                 break;
             }
+            case Level::floor:
+            case Level::ladder:
+            case Level::empty:
+                break; // terrain, kept in m_terrain above
+            }
         }
     }
 
+    m_terrainBoards.walls.clear();
+    m_terrainBoards.ladders.clear();
+    m_terrainBoards.passable.clear();
+    m_terrainBoards.hazards.clear();
+    for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+        for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+            m_terrainBoards.walls.set(xx, yy, m_terrain[yy][xx] == Level::floor);
+            m_terrainBoards.ladders.set(xx, yy, checkClimbable(xx, yy));
+            m_terrainBoards.passable.set(xx, yy, checkPassable(xx, yy));
+            m_terrainBoards.hazards.set(xx, yy, m_level->getContentsOf(xx, yy) == Level::bonfire);
+        }
+    }
+    m_terrainBoards.derive();
+    m_platforms.build(m_terrainBoards.walkable);
+    m_ladderGraph.build(m_terrainBoards, m_platforms);
+    m_flowField.build(m_terrainBoards);
+    for (int yy = 0; yy < VIEW_HEIGHT; yy++) m_passableRows[yy] = m_terrainBoards.passable.row(yy);
+
+    mergeSpawnedActors(); // actors created from the level file start out in their typed lists
+
     return GWSTATUS_CONTINUE_GAME;
 }
 
 int StudentWorld::move()
 {
+    m_tick++;
     updateDisplayText(); // updates game stats text based on latest statistics
 
     if (checkGameStatus() != GWSTATUS_CONTINUE_GAME) return checkGameStatus(); // check if finish conditions reached
+    m_activeActors = 1; // the player always takes a turn
 
+    // Update phase: the player, then each typed list in turn. Actors spawned while updating (barrels, burps,
+    // dropped goodies) are staged in m_spawned, so no list grows while it is being iterated
     m_player->doSomething(); // read user input if conditions met (eg. not frozen)
-    for (int i = 0; i < m_actors.size(); i++) {
-        if (checkGameStatus() != GWSTATUS_CONTINUE_GAME) return checkGameStatus(); // Continuously check if finish conditions are reached
-        if (m_actors[i]->alive()) { // only execute actions on Actors who are alive
-            m_actors[i]->doSomething(); // Each actor carries out their action for one tick
-        }
+    const vector<Actor*>& atPlayer = actorsAt(m_player->getX(), m_player->getY()); // nothing else moves the player, so contacts start from here
+    m_contactCandidates.assign(atPlayer.begin(), atPlayer.end());
+    int status = updateAllActors();
+
+    // Spawn phase: staged actors join their lists and take their first turn this tick, in spawn order
+    while (status == GWSTATUS_CONTINUE_GAME && !m_spawned.empty()) {
+        m_newcomers.assign(m_spawned.begin(), m_spawned.end());
+        mergeSpawnedActors();
+        status = updateNewcomers();
     }
-    if (checkGameStatus() != GWSTATUS_CONTINUE_GAME) return checkGameStatus(); // check if finish conditions reached
 
-    // Remove dead game objects
-    for (vector<Actor*>::iterator it = m_actors.begin(); it != m_actors.end();) {
-        if (!((*it)->alive())) {
-            delete (*it);
-            it = m_actors.erase(it); // update it to next iterator after erased object
-        }
-        else it++;
+    // Contact phase: everything that touched the player this tick is resolved at once, in a fixed order
+    if (status == GWSTATUS_CONTINUE_GAME) status = resolveContacts();
+    m_activeActorTicks += m_activeActors;
+    m_worldActorTicks += m_actors.size();
+    m_peakActiveActors = max(m_peakActiveActors, m_activeActors);
+    if (status != GWSTATUS_CONTINUE_GAME) {
+        mergeSpawnedActors(); // so that cleanUp() releases them
+        return status;
     }
+
+    // Reap phase: drop dead actors from the typed lists, then compact m_actors in a single pass,
+    // releasing dead game objects. Their handles become stale
+    m_bonfires.removeDead();
+    m_fireballs.removeDead();
+    m_koopas.removeDead();
+    m_hunters.removeDead();
+    m_kongs.removeDead();
+    m_barrels.removeDead();
+    m_burps.removeDead();
+    m_garlics.removeDead();
+    m_extraLives.removeDead();
+    m_actors.eraseIf([this](Actor* ap) {
+        if (ap->alive()) return false;
+        removeFromCell(ap, ap->getX(), ap->getY());
+        releaseActor(ap);
+        return true;
+    });
     
     return GWSTATUS_CONTINUE_GAME; // no finish conditions reached
 }
 
 void StudentWorld::cleanUp()
 {
-    while (!m_actors.empty()) { // delete and pop all actors in the m_actors vector
-        delete m_actors.back();
-        m_actors.pop_back();
+    mergeSpawnedActors();
+    for (size_t i = 0; i < m_actors.size(); i++) m_arena.destroy(m_actors[i]); // destroy all actors in m_actors, including the player
+    m_actors.clear();
+    m_bonfires.clear();
+    m_fireballs.clear();
+    m_koopas.clear();
+    m_hunters.clear();
+    m_kongs.clear();
+    m_barrels.clear();
+    m_burps.clear();
+    m_garlics.clear();
+    m_extraLives.clear();
+    m_fireballTimers.clear();
+    m_koopaTimers.clear();
+    m_hunterTimers.clear();
+    m_contactCandidates.clear();
+    m_contactEvents.clear();
+    for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+        for (int xx = 0; xx < VIEW_WIDTH; xx++) m_cellActors[yy][xx].clear(); // buckets keep their capacity for the next level
     }
-    delete m_player; // release memory for player
     m_player = nullptr;
-    delete m_level; // release memory for level object
-    m_level = nullptr;
+    if (m_diagnostics && m_arena.objectsCreated() > 0) {
+        cerr << "Level arena: " << m_arena.objectsCreated() << " objects, " << m_arena.bytesUsed() << " bytes used, "
+             << m_arena.bytesReserved() << " bytes reserved" << endl;
+        cerr << "Pool high-water marks: " << m_barrelPool.highWaterMark() << " barrels, " << m_burpPool.highWaterMark() << " burps, "
+             << m_garlicPool.highWaterMark() + m_extraLifePool.highWaterMark() << " goodies. "
+             << m_barrelPool.recycled() + m_burpPool.recycled() + m_garlicPool.recycled() + m_extraLifePool.recycled()
+             << " actors recycled" << endl;
+    }
+    if (m_diagnostics && m_tick > 0 && m_worldActorTicks > 0) {
+        cerr << "Active actors: " << static_cast<double>(m_activeActorTicks) / m_tick << " per tick on average (peak " << m_peakActiveActors
+             << "), of " << static_cast<double>(m_worldActorTicks) / m_tick << " in the world" << endl;
+    }
+    if (m_diagnostics && m_flowField.recomputations() > 0) {
+        cerr << "Hunter flow field: rebuilt " << m_flowField.recomputations() << " times in " << m_tick << " ticks" << endl;
+    }
+    m_barrelPool.clear(); // destroy the pooled instances, which are not in m_actors
+    m_burpPool.clear();
+    m_garlicPool.clear();
+    m_extraLifePool.clear();
+    m_arena.reset(); // release the whole level's memory at once. Blocks are kept for the next level
+    m_level = nullptr; // the level itself stays in m_levels for the next visit
+}
+
+int StudentWorld::updateAllActors() {
+    // Types are always updated in the same order, so a tick's outcome does not depend on spawn history
+    int status = updateActors(m_bonfires);
+    if (status == GWSTATUS_CONTINUE_GAME) status = updateScheduled<Fireball>(m_fireballTimers);
+    if (status == GWSTATUS_CONTINUE_GAME) status = updateScheduled<Koopa>(m_koopaTimers);
+    if (status == GWSTATUS_CONTINUE_GAME && m_hunters.size() > 0) {
+        m_flowField.update(m_player->getX(), m_player->getY()); // does nothing unless the player is on a new square
+        status = updateScheduled<Hunter>(m_hunterTimers);
+    }
+    if (status == GWSTATUS_CONTINUE_GAME) status = updateActors(m_kongs);
+    if (status == GWSTATUS_CONTINUE_GAME) status = updateBarrels();
+    if (status == GWSTATUS_CONTINUE_GAME) status = updateActors(m_burps);
+    return status; // goodies do nothing until the contact phase picks them up
+}
+
+int StudentWorld::updateBarrels() {
+    if (!m_batchBarrels) return updateActors(m_barrels);
+    m_barrelBatch.clear();
+    for (size_t i = 0; i < m_barrels.size(); i++) {
+        if (!m_barrels[i]->alive()) continue;
+        Entity e = m_barrels[i]->handle();
+        m_barrelBatch.add(e, m_components.x[e.index], m_components.y[e.index], m_components.direction[e.index], m_components.ticks[e.index]);
+    }
+    // Two phases. First every barrel works out its move against the terrain alone, which is read-only, so
+    // fixed chunks of the batch can run on any number of threads. Then the moves are committed serially
+    // in list order, since that touches shared state (the cell index, animation, directions). The result
+    // is the same at every thread count
+    if (m_workers) {
+        auto physics = [this](size_t first, size_t last) { barrelPhysicsBatch(m_passableRows, m_barrelBatch, first, last); };
+        m_workers->parallelFor(m_barrelBatch.size(), BARREL_CHUNK, physics);
+    }
+    else barrelPhysicsBatch(m_passableRows, m_barrelBatch, 0, m_barrelBatch.size());
+
+    // Apply the results in list order. Hitting the player is left to the contact phase
+    for (size_t k = 0; k < m_barrelBatch.size(); k++) {
+        Entity e = m_barrelBatch.entities[k];
+        int oldX = m_components.x[e.index];
+        int oldY = m_components.y[e.index];
+        int newX = m_barrelBatch.x[k];
+        int newY = m_barrelBatch.y[k];
+        m_components.ticks[e.index] = m_barrelBatch.ticks[k];
+        Actor* ap = m_components.actor[e.index];
+        if (newY != oldY) ap->moveTo(oldX, newY); // one moveTo() per step, so animation matches the scalar path
+        if (newX != oldX) ap->moveTo(newX, newY);
+        m_components.x[e.index] = newX;
+        m_components.y[e.index] = newY;
+        updateActorCell(ap, oldX, oldY);
+        if (m_barrelBatch.direction[k] != m_components.direction[e.index]) setEntityDirection(e, m_barrelBatch.direction[k]);
+    }
+    m_activeActors += static_cast<int>(m_barrelBatch.size());
+    return checkGameStatus();
+}
+
+int StudentWorld::updateNewcomers() {
+    for (size_t i = 0; i < m_newcomers.size() && !m_levelComplete; i++) {
+        if (!m_newcomers[i]->alive()) continue;
+        m_newcomers[i]->doSomething(); // few actors spawn per tick, so these calls stay virtual
+        m_activeActors++;
+    }
+    return checkGameStatus();
+}
+
+int StudentWorld::resolveContacts() {
+    int px = m_player->getX();
+    int py = m_player->getY();
+    // Join the player's square with the cell index. Actors that were on it when the player moved still count
+    // if they have since walked off, so the player and an enemy can't swap squares without touching
+    const vector<Actor*>& atPlayer = actorsAt(px, py);
+    for (size_t i = 0; i < atPlayer.size(); i++) {
+        if (find(m_contactCandidates.begin(), m_contactCandidates.end(), atPlayer[i]) == m_contactCandidates.end()) m_contactCandidates.push_back(atPlayer[i]);
+    }
+
+    m_contactEvents.clear();
+    for (size_t i = 0; i < m_contactCandidates.size(); i++) {
+        Entity e = m_contactCandidates[i]->handle();
+        int flags = m_components.flags[e.index];
+        if (!(flags & CAP_ALIVE)) continue; // killed earlier in the tick
+        if (flags & CAP_HARMFUL) m_contactEvents.push_back(ContactEvent{ CONTACT_DAMAGE, e });
+        if ((flags & CAP_FREEZES) && m_tick >= m_components.freezeReadyTick[e.index]) m_contactEvents.push_back(ContactEvent{ CONTACT_FREEZE, e });
+        if (flags & CAP_PICKUP) m_contactEvents.push_back(ContactEvent{ CONTACT_PICKUP, e });
+    }
+    forEachActorIn(px - MIN_EUCLID_DISTANCE, py - MIN_EUCLID_DISTANCE, px + MIN_EUCLID_DISTANCE, py + MIN_EUCLID_DISTANCE, [this](Actor* ap) {
+        int flags = m_components.flags[ap->handle().index];
+        if ((flags & CAP_FLEES) && (flags & CAP_ALIVE) && closeToPlayer(ap->getX(), ap->getY())) m_contactEvents.push_back(ContactEvent{ CONTACT_FLEE, ap->handle() });
+    });
+
+    contactSystem(*this, m_contactEvents);
+    for (size_t i = 0; i < m_contactEvents.size(); i++) {
+        if (m_contactEvents[i].type == CONTACT_PICKUP) m_activeActors++; // a dormant goodie woken by the player
+    }
+    return checkGameStatus();
+}
+
+void StudentWorld::setSeed(uint64_t seed) {
+    m_random.seed(seed);
+}
+
+int StudentWorld::step(int key) {
+    m_stepKey = key;
+    m_hasStepKey = true;
+    int status = move();
+    m_hasStepKey = false; // a key the player didn't read this tick (eg. mid-jump) is dropped, not kept for the next
+    return status;
+}
+
+bool StudentWorld::playerKey(int& value) {
+    if (!m_hasStepKey) return getKey(value);
+    if (m_stepKey == INVALID_KEY) return false;
+    value = m_stepKey;
+    m_stepKey = INVALID_KEY; // read at most once per tick, like a key from the host
+    return true;
+}
+
+void StudentWorld::setDiagnostics(bool on) {
+    m_diagnostics = on;
+}
+
+void StudentWorld::setUpdateThreads(int n) {
+    if (n == updateThreads()) return;
+    if (n <= 1) m_workers.reset();
+    else m_workers.reset(new WorkerPool(n));
+}
+
+void StudentWorld::setBarrelBatching(bool on) {
+    m_batchBarrels = on;
+}
+
+int StudentWorld::updateThreads() const {
+    return m_workers ? m_workers->size() : 1;
 }
 
-int StudentWorld::loadLevel() {
-    // cerr << "Lives " << getLives() << endl;
+int StudentWorld::currentTick() const {
+    return m_tick;
+}
+
+int StudentWorld::activeActorCount() const {
+    return m_activeActors;
+}
+
+int StudentWorld::actorCount() const {
+    return static_cast<int>(m_actors.size());
+}
+
+const vector<ContactEvent>& StudentWorld::contactEvents() const {
+    return m_contactEvents;
+}
+
+void StudentWorld::mergeSpawnedActors() {
+    m_spawned.clear(); // they are already in m_actors, from when they were constructed
+    m_bonfires.merge();
+    mergeScheduled(m_fireballs, m_fireballTimers);
+    mergeScheduled(m_koopas, m_koopaTimers);
+    mergeScheduled(m_hunters, m_hunterTimers);
+    m_kongs.merge();
+    m_barrels.merge();
+    m_burps.merge();
+    m_garlics.merge();
+    m_extraLives.merge();
+}
+
+int StudentWorld::loadLevel(int n_level) {
+    if (n_level > 99) return GWSTATUS_PLAYER_WON; // maximum level reached => win condition
+    if (m_levelCount >= 0 && n_level >= m_levelCount) return GWSTATUS_PLAYER_WON; // no more higher levels => win condition
+    if (n_level < static_cast<int>(m_levels.size()) && m_levels[n_level]) {
+        if (m_diagnostics) cerr << "Level " << n_level << " already loaded" << endl; // read on an earlier visit, eg. before the player lost a life
+        return GWSTATUS_CONTINUE_GAME;
+    }
 
     // Generate file string based on level number
     string curLevel = "level";
-    int n_level = getLevel();
-    if (n_level > 99) return GWSTATUS_PLAYER_WON; // maximum level reached => win condition
     if (n_level < 10) curLevel += "0";
     else {
         curLevel += (n_level / 10) + '0';
     }
     curLevel += (n_level % 10) + '0';
     curLevel += ".txt";
-    m_level = new Level(assetPath());
-    Level::LoadResult result = m_level->loadLevel(curLevel); // try to load level
+    unique_ptr<Level> level(new Level(assetPath()));
+    Level::LoadResult result = level->loadLevel(curLevel); // try to load level
     if (result == Level::load_fail_file_not_found) {
-        delete m_level;
-        m_level = nullptr; // safe to delete nullptr later, if necessary. Also acts as a flag for unloaded level
-        cerr << "File not found." << endl;
+        m_levelCount = n_level;
+        if (m_diagnostics) cerr << "File not found." << endl;
         return GWSTATUS_PLAYER_WON; // no more higher levels => win condition
     }
     else if (result == Level::load_fail_bad_format) {
-        delete m_level;
-        m_level = nullptr;
-        cerr << "File bad format." << endl;
+        if (m_diagnostics) cerr << "File bad format." << endl;
         return GWSTATUS_LEVEL_ERROR; // error loading file
     }
 
     // otherwise the load was successful and we can access contents of level
-    cerr << "Level "<<getLevel()<<" successfully loaded" << endl;
+    if (static_cast<int>(m_levels.size()) <= n_level) m_levels.resize(n_level + 1);
+    m_levels[n_level] = std::move(level);
+    if (m_diagnostics) cerr << "Level " << n_level << " successfully loaded" << endl;
     return GWSTATUS_CONTINUE_GAME; // successfully loaded => continue game
 }
 
+void StudentWorld::reserveForLevels() {
+    // Reads levels until one is missing or can't be read, which init() reports once the game gets there
+    int most[Level::hunter + 1] = {}; // most squares of each kind in any one level
+    for (int n = 0; loadLevel(n) == GWSTATUS_CONTINUE_GAME; n++) {
+        int count[Level::hunter + 1] = {};
+        for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+            for (int xx = 0; xx < VIEW_WIDTH; xx++) count[m_levels[n]->getContentsOf(xx, yy)]++;
+        }
+        for (int k = 0; k <= Level::hunter; k++) most[k] = max(most[k], count[k]);
+    }
+
+    // Level actors come from the level files alone. Kong stops throwing at MAX_BARRELS_IN_PLAY live barrels, a burp
+    // lasts fewer ticks than BURP_POOL_CAPACITY and the player fires at most one a tick, and each fireball or koopa
+    // drops at most one garlic or extra life when it dies. A pool only creates an actor when none waits for reuse,
+    // so it never holds more than these bounds either
+    int kongs = most[Level::left_kong] + most[Level::right_kong];
+    int garlics = most[Level::garlic] + most[Level::fireball];
+    int extraLives = most[Level::extra_life] + most[Level::koopa];
+    m_bonfires.reserve(most[Level::bonfire]);
+    m_fireballs.reserve(most[Level::fireball]);
+    m_koopas.reserve(most[Level::koopa]);
+    m_hunters.reserve(most[Level::hunter]);
+    m_kongs.reserve(kongs);
+    m_barrels.reserve(MAX_BARRELS_IN_PLAY);
+    m_burps.reserve(BURP_POOL_CAPACITY);
+    m_garlics.reserve(garlics);
+    m_extraLives.reserve(extraLives);
+    size_t actors = 1 + most[Level::bonfire] + most[Level::fireball] + most[Level::koopa] + most[Level::hunter] + kongs
+        + MAX_BARRELS_IN_PLAY + BURP_POOL_CAPACITY + garlics + extraLives; // the player too
+    m_actors.reserve(actors);
+    m_components.reserve(actors);
+    graphObjects().reserve(actors);
+    m_spawned.reserve(actors);
+    m_newcomers.reserve(actors);
+    m_expiredTimers.reserve(max(max(most[Level::fireball], most[Level::koopa]), most[Level::hunter]));
+    m_arena.reserve(actors, LARGEST_ACTOR_SIZE);
+}
+
+int StudentWorld::getTileImageID(int xx, int yy) const {
+    if (m_level == nullptr || !checkBounds(xx, yy)) return IID_NONE; // no level loaded
+    if (m_terrain[yy][xx] == Level::floor) return IID_FLOOR;
+    if (m_terrain[yy][xx] == Level::ladder) return IID_LADDER;
+    return IID_NONE;
+}
+
 bool StudentWorld::checkPassable(int xx, int yy) const {
     // check if wall. If indexes are not valid, returns false
     if (!checkIndex(xx, yy)) return false; // check indexes are valid
-    for (int i = 0; i < m_actors.size(); i++) {
-        if (m_actors[i]->getX() == xx && m_actors[i]->getY() == yy && !m_actors[i]->passable()) return false;
-    }
-    return true;
+    return m_terrain[yy][xx] != Level::floor;
 }
 
 bool StudentWorld::checkClimbable(int xx, int yy) const {
     // check if ladder. If indexes are not valid, returns false
-    for (int i = 0; i < m_actors.size(); i++) {
-        if (m_actors[i]->getX() == xx && m_actors[i]->getY() == yy && m_actors[i]->climbable()) return true;
+    if (!checkBounds(xx, yy)) return false;
+    return m_terrain[yy][xx] == Level::ladder;
+}
+
+Bitboard StudentWorld::occupiedSquares() const {
+    Bitboard occupied;
+    for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+        for (int xx = 0; xx < VIEW_WIDTH; xx++) {
+            const vector<Actor*>& bucket = m_cellActors[yy][xx];
+            for (size_t i = 0; i < bucket.size(); i++) {
+                if (bucket[i]->alive()) {
+                    occupied.set(xx, yy);
+                    break;
+                }
+            }
+        }
     }
-    return false;
+    return occupied;
 }
 
-void StudentWorld::addActor(Actor* ap) {
-    m_actors.push_back(ap);
+void StudentWorld::releaseActor(Actor* ap) {
+    if (ap->pool() != nullptr) ap->pool()->release(ap); // hidden and kept for reuse
+    else m_arena.destroy(ap); // its memory is reused by the next actor of the same size
+}
+
+Actor* StudentWorld::getActor(ActorHandle h) const {
+    Actor* const* app = m_actors.get(h);
+    return app == nullptr ? nullptr : *app;
+}
+
+Entity StudentWorld::registerActor(Actor* ap) {
+    Entity e = m_actors.insert(ap);
+    m_components.initRow(e.index, ap, ap->getX(), ap->getY(), ap->getDirection());
+    return e;
+}
+
+bool StudentWorld::moveEntity(Entity e, int xx, int yy) {
+    if (!checkPassable(xx, yy)) return false;
+    int oldX = m_components.x[e.index];
+    int oldY = m_components.y[e.index];
+    m_components.x[e.index] = xx;
+    m_components.y[e.index] = yy;
+    Actor* ap = m_components.actor[e.index];
+    ap->moveTo(xx, yy);
+    updateActorCell(ap, oldX, oldY); // keep the per-cell index in sync with the new position
+    return true;
+}
+
+void StudentWorld::setEntityDirection(Entity e, int dir) {
+    m_components.direction[e.index] = dir;
+    m_components.actor[e.index]->GraphObject::setDirection(dir);
+}
+
+void StudentWorld::updateActorCell(Actor* ap, int oldX, int oldY) {
+    if (oldX == ap->getX() && oldY == ap->getY()) return;
+    if (!removeFromCell(ap, oldX, oldY)) return; // not indexed (eg. the player)
+    if (checkBounds(ap->getX(), ap->getY())) {
+        m_cellActors[ap->getY()][ap->getX()].push_back(ap);
+    }
+}
+
+const vector<Actor*> StudentWorld::s_noActors;
+
+const vector<Actor*>& StudentWorld::actorsAt(int xx, int yy) const {
+    if (!checkBounds(xx, yy)) return s_noActors;
+    return m_cellActors[yy][xx];
+}
+
+bool StudentWorld::removeFromCell(Actor* ap, int xx, int yy) {
+    if (!checkBounds(xx, yy)) return false;
+    vector<Actor*>& bucket = m_cellActors[yy][xx];
+    vector<Actor*>::iterator it = find(bucket.begin(), bucket.end(), ap);
+    if (it == bucket.end()) return false;
+    bucket.erase(it); // buckets are tiny, and erase keeps arrival order stable
+    return true;
 }
 
 void StudentWorld::attackEnemy(int xx, int yy, bool isBonfire) {
-    for (int i = 0; i < m_actors.size(); i++) {
-        if (m_actors[i]->getX() == xx && m_actors[i]->getY() == yy) {
-            if (!isBonfire && m_actors[i]->blastable()) { // attack Enemy with Burp
-                m_actors[i]->kill();
-                playSound(SOUND_ENEMY_DIE);
-                increaseScore(ENEMY_DIE_POINTS);
-            }
-            else if (isBonfire && m_actors[i]->burnable()) { // attack Barrel with Bonfire
-                m_actors[i]->kill();
-            }
-            
+    if (!checkBounds(xx, yy)) return;
+    const vector<Actor*>& bucket = m_cellActors[yy][xx]; // only actors on this square. Indexed loop since kill() may drop a goodie here
+    for (size_t i = 0; i < bucket.size(); i++) {
+        if (!isBonfire && bucket[i]->blastable()) { // attack Enemy with Burp
+            bucket[i]->kill();
+            playSound(SOUND_ENEMY_DIE);
+            increaseScore(ENEMY_DIE_POINTS);
+        }
+        else if (isBonfire && bucket[i]->burnable()) { // attack Barrel with Bonfire
+            bucket[i]->kill();
         }
     }
 }
@@ -206,24 +587,45 @@ void StudentWorld::increaseBurps(int k) {
 }
 
 void StudentWorld::updateDisplayText() {
-    ostringstream oss;
-    oss << "Score: " << num2string(getScore(), 7) << "  ";
-    oss << "Level: " << num2string(getLevel(), 2) << "  ";
-    oss << "Lives: " << num2string(getLives(), 2) << "  ";
-    oss << "Burps: " << num2string(m_player->getBurps(), 2);
-    setGameStatText(oss.str());
+    int stats[4] = { getScore(), getLevel(), getLives(), m_player->getBurps() };
+    if (equal(stats, stats + 4, m_displayedStats)) return; // only rebuild the text when a statistic changes
+    copy(stats, stats + 4, m_displayedStats);
+
+    // Rebuilt in place, into room reserved up front, so a change of score doesn't allocate
+    m_statText.clear();
+    m_statText += "Score: ";
+    m_statText += num2string(getScore(), 7);
+    m_statText += "  Level: ";
+    m_statText += num2string(getLevel(), 2);
+    m_statText += "  Lives: ";
+    m_statText += num2string(getLives(), 2);
+    m_statText += "  Burps: ";
+    m_statText += num2string(m_player->getBurps(), 2);
+    setGameStatText(m_statText);
 }
 
 bool StudentWorld::checkPlayerAlive() const {
     return m_player->alive();
 }
 
+int StudentWorld::barrelsInPlay() const {
+    return m_barrelPool.inUse();
+}
+
+void StudentWorld::createBarrel(int xx, int yy, int dir) {
+    addActor(m_barrels, m_barrelPool.acquire(xx, yy, dir));
+}
+
+void StudentWorld::createBurp(int xx, int yy, int dir) {
+    addActor(m_burps, m_burpPool.acquire(xx, yy, dir));
+}
+
 void StudentWorld::dropGarlic(int xx, int yy) {
-    addActor(new GarlicGoodie(this, xx, yy));
+    addActor(m_garlics, m_garlicPool.acquire(xx, yy));
 }
 
 void StudentWorld::dropExtraLife(int xx, int yy) {
-    addActor(new ExtraLifeGoodie(this, xx, yy));
+    addActor(m_extraLives, m_extraLifePool.acquire(xx, yy));
 }
 
 bool StudentWorld::closeToPlayer(int xx, int yy) {
@@ -248,6 +650,10 @@ bool checkIndex(int xx, int yy) {
     return xx > 0 && yy > 0 && xx < VIEW_WIDTH && yy < VIEW_HEIGHT;
 }
 
+bool checkBounds(int xx, int yy) {
+    return xx >= 0 && yy >= 0 && xx < VIEW_WIDTH && yy < VIEW_HEIGHT; // unlike checkIndex, includes the border squares
+}
+
 string num2string(int x, int digits) {
     string numString = "";
     for (int i = 0; i < digits; i ++) {
@@ -4,13 +4,36 @@
 #include "GameWorld.h"
 #include "Level.h"
 #include "Actor.h"
+#include "SlotMap.h"
+#include "Arena.h"
+#include "ActorPool.h"
+#include "ActorList.h"
+#include "Components.h"
+#include "Systems.h"
+#include "Bitboard.h"
+#include "PlatformSegments.h"
+#include "LadderGraph.h"
+#include "FlowField.h"
+#include "TimerWheel.h"
+#include "Random.h"
+#include "WorkerPool.h"
 #include <string>
 #include <vector>
+#include <utility>
+#include <memory>
 
 // Students:  Add code to this file, StudentWorld.cpp, Actor.h, and Actor.cpp
 
 const int ENEMY_DIE_POINTS = 100;
 const int MIN_EUCLID_DISTANCE = 2;
+const int BARREL_POOL_CAPACITY = 256; // most dead barrels kept for reuse
+const int MAX_BARRELS_IN_PLAY = BARREL_POOL_CAPACITY; // Kong holds his throw while this many barrels are live
+const int BURP_POOL_CAPACITY = 16; // most dead burps kept for reuse
+const int GOODIE_POOL_CAPACITY = 32; // most dead goodies of each kind kept for reuse
+const int CELL_BUCKET_CAPACITY = 4; // actors per square the index has room for before it allocates
+const int BARREL_CHUNK = 64; // barrels per chunk of the parallel phase. A multiple of 8, so chunks split on AVX2 lane boundaries
+
+bool checkBounds(int xx, int yy); // checks if (xx, yy) is anywhere on the board, including the border
 
 class StudentWorld : public GameWorld
 {
@@ -20,28 +43,227 @@ public:
   virtual int init();
   virtual int move();
   virtual void cleanUp();
+  virtual int getTileImageID(int xx, int yy) const; // image of the floor or ladder tile at (xx, yy), drawn by the framework
   bool checkPassable(int xx, int yy) const; // check if square has walls
   bool checkClimbable(int xx, int yy) const; // check if square has ladders
-  void addActor(Actor* ap); // add an object of base class Actor to the vector m_actors
+  const TerrainBitboards& terrainBoards() const; // whole-board terrain queries for the current level
+  const PlatformSegments& platformSegments() const; // patrol segment ends for every square of the current level
+  const LadderGraph& ladderGraph() const; // ladders of the current level, the platforms they join and where they can be climbed
+  const FlowField& flowField() const; // shortest moves to the player's square, refreshed before hunters update
+  Bitboard occupiedSquares() const; // squares holding at least one live actor other than the player, rebuilt from the cell index on each call
+  Actor* getActor(ActorHandle h) const; // actor referred to by h, or nullptr if it has been removed
+  Entity registerActor(Actor* ap); // adds ap to m_actors and gives it a fresh component row. Called as each actor is constructed or recycled
+  ComponentArrays& components(); // per-entity state, indexed by Entity::index
+  const ComponentArrays& components() const;
+  bool entityAlive(Entity e) const; // true if e has not been removed and has not been killed
+  bool moveEntity(Entity e, int xx, int yy); // moves e to (xx, yy) unless there is a wall or it is out of bounds. Returns true if it moved
+  void setEntityDirection(Entity e, int dir); // turns e to face dir
+  void updateActorCell(Actor* ap, int oldX, int oldY); // move ap from the index bucket at (oldX, oldY) to the one at its current square
+  const std::vector<Actor*>& actorsAt(int xx, int yy) const; // actors (including ones killed this tick) indexed at square (xx, yy)
+  template <typename Func>
+  void forEachActorIn(int x1, int y1, int x2, int y2, Func f) const; // calls f(Actor*) for every indexed actor in the inclusive rectangle
   void attackEnemy(int xx, int yy, bool isBonfire = false); // attack (i.e. kill) all enemies in square (xx, yy). If isBonfire is set to true, we only attack barrels.
   void attackPlayer(); // kill the player
   void freezePlayer(); // freeze the player
   bool isPlayerLocation(int xx, int yy); // check if player is at square (xx, yy)
   void increaseBurps(int k); // increment player's number of burps by k
   bool checkPlayerAlive() const; // checks if player is still alive
+  const Player* getPlayer() const; // nullptr between cleanUp() and init()
+  int barrelsInPlay() const; // barrels spawned and not yet removed, including ones killed this tick
+  void createBarrel(int xx, int yy, int dir); // adds a recycled or new Barrel Actor to m_actors
+  void createBurp(int xx, int yy, int dir); // adds a recycled or new Burp Actor to m_actors
   void dropGarlic(int xx, int yy); // adds Garlic Goodie Actor to m_actors
   void dropExtraLife(int xx, int yy); // adds ExtraLife Goodie Actor to m_actors
   bool closeToPlayer(int xx, int yy); // check if (xx,yy) is less than the euclidean distance MIN_EUCLID_DISTANCE from player
+  Random& random(); // gameplay randomness. Seeded from std::random_device unless setSeed() is called
+  void setSeed(uint64_t seed); // restarts random() from seed, so the same seed and key presses replay the same game
+  int step(int key); // move(), with key as the player's input for this tick in place of the host's. INVALID_KEY for no key
+  bool playerKey(int& value); // the key the player acts on this tick: step()'s inside a step(), otherwise the host's
+  void setDiagnostics(bool on); // whether init() and cleanUp() report on the level to cerr. On by default
+  void setUpdateThreads(int n); // runs the parallel phase of each tick on n threads. 1, the default, keeps everything on the calling thread
+  void setBarrelBatching(bool on); // whether barrels move as one batch, the default, or each through its own doSomething(). The game is the same either way
+  int updateThreads() const;
+  int currentTick() const; // ticks since the level started, counting the one in progress
+  int activeActorCount() const; // actors that took a turn in the last tick, including the player and any woken by contact. The rest were dormant
+  int actorCount() const; // actors in the world, including the player and any spawned but not yet merged into their lists
+  const std::vector<ContactEvent>& contactEvents() const; // contacts that took effect in the last tick's contact phase, in resolution order
   void setLevelComplete(); // setter function for m_levelComplete
 
 private:
+	LevelArena m_arena; // backs every actor of the current level, including the player. Declared first so it outlives them
+	ActorPool<Barrel> m_barrelPool; // high-churn actors are recycled rather than destroyed
+	ActorPool<Burp> m_burpPool;
+	ActorPool<GarlicGoodie> m_garlicPool;
+	ActorPool<ExtraLifeGoodie> m_extraLifePool;
 	Player* m_player;
-	Level* m_level;
-	std::vector<Actor* > m_actors;
+	Level* m_level; // current level, one of m_levels. nullptr between cleanUp() and init()
+	std::vector<std::unique_ptr<Level>> m_levels; // every level loaded so far, by number, so replaying one doesn't read its file again
+	int m_levelCount; // levels there are, once a missing file has shown where they end. -1 until then
+	SlotMap<Actor*> m_actors; // every actor, including the player, from construction until it is reaped. Owns their handles; updates go through the typed lists below
+	ComponentArrays m_components; // state of every actor in m_actors, one row per handle index
+	// Actors are updated type by type, each in a tight loop, always in this order:
+	// bonfires, fireballs, koopas, hunters, kong, barrels, burps. Which actors take a turn depends on how they wake:
+	// - every tick: the player, bonfires, kong, barrels and burps, which animate or move each tick
+	// - on a timer: fireballs, koopas and hunters, woken by their type's timer wheel
+	// - on contact: goodies, and kong's fleeing, woken by the player reaching them in the contact phase
+	// Dormant actors cost nothing until their wake condition fires
+	ActorList<Bonfire> m_bonfires;
+	ActorList<Fireball> m_fireballs;
+	ActorList<Koopa> m_koopas;
+	ActorList<Hunter> m_hunters;
+	ActorList<Kong> m_kongs;
+	ActorList<Barrel> m_barrels;
+	ActorList<Burp> m_burps;
+	ActorList<GarlicGoodie> m_garlics;
+	ActorList<ExtraLifeGoodie> m_extraLives;
+	TimerWheel m_fireballTimers; // one wheel per type, so types still update in the order above
+	TimerWheel m_koopaTimers;
+	TimerWheel m_hunterTimers;
+	std::vector<TimerWheel::Timer> m_expiredTimers; // scratch space for updateScheduled(), kept between ticks so it doesn't allocate
+	Random m_random; // owned by this world alone, so worlds never share generator state
+	int m_tick; // ticks since init()
+	int m_activeActors; // actors that have taken a turn so far this tick
+	int m_peakActiveActors; // most active actors in any tick of the level
+	long long m_activeActorTicks; // sum of m_activeActors over the level's ticks, for the report in cleanUp()
+	long long m_worldActorTicks; // sum over the level's ticks of the actors in m_actors
+	std::vector<Actor*> m_spawned; // actors added since the last merge, in spawn order
+	std::vector<Actor*> m_newcomers; // actors taking their first turn in the spawn phase of move()
+	Level::MazeEntry m_terrain[VIEW_HEIGHT][VIEW_WIDTH]; // static terrain (floor, ladder or empty) built once per level in init()
+	TerrainBitboards m_terrainBoards; // m_terrain as bitboards, plus the neighbourhood queries derived from them. Built with m_terrain
+	PlatformSegments m_platforms; // built from m_terrainBoards.walkable
+	LadderGraph m_ladderGraph; // built from m_terrainBoards and m_platforms
+	FlowField m_flowField; // movement graph built from m_terrainBoards. Shared by every hunter
+	unsigned int m_passableRows[VIEW_HEIGHT]; // row yy of m_terrainBoards.passable, in the layout barrelPhysicsBatch() gathers from
+	BarrelBatch m_barrelBatch; // scratch space for updateBarrels(), kept between ticks so it doesn't allocate
+	std::unique_ptr<WorkerPool> m_workers; // threads for the parallel phase of updateBarrels(), or null on one thread
+	std::vector<Actor*> m_contactCandidates; // actors on the player's square once the player has moved, plus the ones there at the end of the tick
+	std::vector<ContactEvent> m_contactEvents; // built by resolveContacts(), kept between ticks so it doesn't allocate
+	std::vector<Actor*> m_cellActors[VIEW_HEIGHT][VIEW_WIDTH]; // index of actors in the typed lists bucketed by square. Dead actors stay until removed in move()
+	static const std::vector<Actor*> s_noActors; // returned by actorsAt() for squares off the board
+	template <typename T>
+	void addActor(ActorList<T>& list, T* ap); // stage an arena-allocated actor to be merged into list
+	template <typename T, typename... Args>
+	T* createActor(ActorList<T>& list, Args... args); // construct a T(this, args...) in the level arena and add it
+	void releaseActor(Actor* ap); // returns a dead actor to its pool, or destroys it if it is not pooled
+	bool removeFromCell(Actor* ap, int xx, int yy); // erase ap from the index bucket at (xx, yy). Returns false if it was not there
 	bool m_levelComplete; // initially set to false
-	int loadLevel(); // helper function to load level from file
+	bool m_diagnostics; // whether init() and cleanUp() report to cerr
+	int m_stepKey; // the player's key for the step() in progress
+	bool m_hasStepKey; // true only inside step()
+	bool m_batchBarrels; // false to update barrels one at a time, for checking the batch against
+	int loadLevel(int n_level); // reads level n_level's file into m_levels, unless an earlier call already has
+	void reserveForLevels(); // reads every level and makes room for the most actors a game can hold, so later ticks and levels don't allocate
 	void updateDisplayText(); // sets the game stats text
+	int m_displayedStats[4]; // score, level, lives and burps in the current game stats text
+	std::string m_statText; // the current game stats text
 	int checkGameStatus(); // returns player died, finished level or continue game
+	template <typename T>
+	int updateActors(ActorList<T>& list); // calls doSomething() on live actors in list. Returns the game status
+	template <typename T>
+	int updateScheduled(TimerWheel& timers); // calls doSomething() on the live T actors due this tick, then reschedules them by T::nextWakeup(). Returns the game status
+	template <typename T>
+	void mergeScheduled(ActorList<T>& list, TimerWheel& timers); // merges list's staged actors and wakes them next tick
+	int updateAllActors(); // updates every typed list in order. Returns the game status
+	int updateBarrels(); // same result as updateActors(m_barrels), with the physics for all barrels done in one batch, split across m_workers
+	int updateNewcomers(); // gives each actor in m_newcomers its first turn. Returns the game status
+	int resolveContacts(); // turns m_contactCandidates and actors near the player into contact events and applies them. Returns the game status
+	void mergeSpawnedActors(); // moves the actors staged in m_spawned into every typed list
 };
 
+inline ComponentArrays& StudentWorld::components() {
+	return m_components;
+}
+
+inline const ComponentArrays& StudentWorld::components() const {
+	return m_components;
+}
+
+inline const Player* StudentWorld::getPlayer() const {
+	return m_player;
+}
+
+inline Random& StudentWorld::random() {
+	return m_random;
+}
+
+inline const TerrainBitboards& StudentWorld::terrainBoards() const {
+	return m_terrainBoards;
+}
+
+inline const PlatformSegments& StudentWorld::platformSegments() const {
+	return m_platforms;
+}
+
+inline const LadderGraph& StudentWorld::ladderGraph() const {
+	return m_ladderGraph;
+}
+
+inline const FlowField& StudentWorld::flowField() const {
+	return m_flowField;
+}
+
+inline bool StudentWorld::entityAlive(Entity e) const { // called for every actor every tick, so kept inline
+	return m_actors.contains(e) && (m_components.flags[e.index] & CAP_ALIVE) != 0;
+}
+
+template <typename T>
+void StudentWorld::addActor(ActorList<T>& list, T* ap) {
+	list.stage(ap);
+	m_spawned.push_back(ap);
+	if (checkBounds(ap->getX(), ap->getY())) m_cellActors[ap->getY()][ap->getX()].push_back(ap); // visible to the index straight away
+}
+
+template <typename T, typename... Args>
+T* StudentWorld::createActor(ActorList<T>& list, Args... args) { // arguments by value, so constants like GraphObject::left need no definition
+	T* ap = m_arena.create<T>(this, args...);
+	addActor(list, ap);
+	return ap;
+}
+
+template <typename T>
+int StudentWorld::updateActors(ActorList<T>& list) {
+	// The player only dies in the contact phase, so during updates the level can only end by being completed
+	for (size_t i = 0; i < list.size() && !m_levelComplete; i++) {
+		if (!list[i]->alive()) continue;
+		list[i]->doSomething(); // T is final, so this call is not virtual
+		m_activeActors++;
+	}
+	return checkGameStatus();
+}
+
+template <typename T>
+int StudentWorld::updateScheduled(TimerWheel& timers) {
+	timers.advance(m_expiredTimers);
+	for (size_t i = 0; i < m_expiredTimers.size() && !m_levelComplete; i++) {
+		const TimerWheel::Timer& t = m_expiredTimers[i];
+		if (!entityAlive(t.entity)) continue; // killed, or reaped and its slot reused, while it slept
+		int& ticks = m_components.ticks[t.entity.index];
+		ticks = (ticks + t.delay - 1) % MAX_MOD_FACTOR; // catch up on the ticks slept through. doSomething() counts this one
+		T* ap = static_cast<T*>(m_components.actor[t.entity.index]);
+		ap->doSomething(); // T is final, so this call is not virtual
+		m_activeActors++;
+		if (ap->alive()) timers.schedule(t.entity, ap->nextWakeup());
+	}
+	return checkGameStatus();
+}
+
+template <typename T>
+void StudentWorld::mergeScheduled(ActorList<T>& list, TimerWheel& timers) {
+	for (size_t i = list.merge(); i < list.size(); i++) timers.schedule(list[i]->handle(), 1); // a newcomer's first turn is taken in move(), outside the wheel
+}
+
+template <typename Func>
+void StudentWorld::forEachActorIn(int x1, int y1, int x2, int y2, Func f) const {
+	if (x1 < 0) x1 = 0;
+	if (y1 < 0) y1 = 0;
+	if (x2 >= VIEW_WIDTH) x2 = VIEW_WIDTH - 1;
+	if (y2 >= VIEW_HEIGHT) y2 = VIEW_HEIGHT - 1;
+	for (int yy = y1; yy <= y2; yy++) {
+		for (int xx = x1; xx <= x2; xx++) {
+			const std::vector<Actor*>& bucket = m_cellActors[yy][xx];
+			for (size_t i = 0; i < bucket.size(); i++) f(bucket[i]);
+		}
+	}
+}
+
 #endif // STUDENTWORLD_H_
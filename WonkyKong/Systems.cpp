@@ -0,0 +1,239 @@
+#include "Systems.h"
+#include "StudentWorld.h"
+#include "Actor.h"
+#include "GameConstants.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_DEBUG)
+#include <cassert>
+#endif
+
+bool sampleChance(Random& rng); // returns true randomly 1/3 of the time
+
+namespace {
+	struct TickTable { // onTick[t] is -1 if a barrel with tick phase t rolls this tick, 0 otherwise
+		int onTick[MAX_MOD_FACTOR];
+		TickTable() {
+			for (int t = 0; t < MAX_MOD_FACTOR; t++) onTick[t] = (t % TICK_FACTOR == 0) ? -1 : 0;
+		}
+	};
+	const TickTable s_tickTable;
+
+	inline bool passableBit(const unsigned int passableRows[], int xx, int yy) {
+		return ((passableRows[yy] >> xx) & 1) != 0;
+	}
+
+	inline int flipDirection(int dir) { // left <-> right
+		return GraphObject::left + GraphObject::right - dir;
+	}
+}
+
+bool unsupported(const StudentWorld& sw, Entity e) {
+	const ComponentArrays& c = sw.components();
+	int x = c.x[e.index];
+	int y = c.y[e.index];
+	const TerrainBitboards& terrain = sw.terrainBoards();
+	if (c.flags[e.index] & CAP_HELD_BY_LADDERS) return terrain.canFall.test(x, y); // not on or standing above a ladder, nor on a floor
+	return terrain.passable.test(x, y - 1); // not standing on a floor
+}
+
+bool gravitySystem(StudentWorld& sw, Entity e) {
+	if (!unsupported(sw, e)) return false;
+	ComponentArrays& c = sw.components();
+	sw.moveEntity(e, c.x[e.index], c.y[e.index] - 1);
+	return true;
+}
+
+void patrolSystem(StudentWorld& sw, Entity e) {
+	ComponentArrays& c = sw.components();
+	int dx = c.direction[e.index] == GraphObject::left ? -1 : 1;
+	int x = c.x[e.index];
+	int y = c.y[e.index];
+	bool blocked;
+	if (c.flags[e.index] & CAP_AVOIDS_CLIFFS) { // stay within the platform segment
+		blocked = !sw.platformSegments().canStep(x, y, dx);
+		if (!blocked) sw.moveEntity(e, x + dx, y);
+	}
+	else blocked = !sw.moveEntity(e, x + dx, y); // only walls turn it around
+	if (blocked) {
+		sw.setEntityDirection(e, dx < 0 ? GraphObject::right : GraphObject::left); // reverse at the end of the path
+	}
+}
+
+bool climbSystem(StudentWorld& sw, Entity e) {
+	ComponentArrays& c = sw.components();
+	const LadderGraph& ladders = sw.ladderGraph();
+	int& state = c.climbingState[e.index];
+	int x = c.x[e.index];
+	int y = c.y[e.index];
+	if (state != STATE_CLIMBING_DOWN && ladders.canClimbUp(x, y)) {
+		if (state == STATE_CLIMBING_UP || sampleChance(sw.random())) {
+			// climb up ladder, by following original motion or randomly deciding if originally not climbing
+			state = STATE_CLIMBING_UP;
+			sw.moveEntity(e, x, y + 1);
+			return true;
+		}
+	}
+	else if (state != STATE_CLIMBING_UP && ladders.canClimbDown(x, y)) {
+		if (state == STATE_CLIMBING_DOWN || sampleChance(sw.random())) {
+			// climb down ladder, by following original motion or randomly deciding if originally not climbing
+			state = STATE_CLIMBING_DOWN;
+			sw.moveEntity(e, x, y - 1);
+			return true;
+		}
+	}
+	// stop climbing once the ladder runs out or a floor is in the way
+	if ((state == STATE_CLIMBING_UP && !ladders.canClimbUp(x, y)) || (state == STATE_CLIMBING_DOWN && !ladders.ladderContinuesDown(x, y))) {
+		state = STATE_NOT_CLIMBING;
+	}
+	return false;
+}
+
+void contactSystem(StudentWorld& sw, std::vector<ContactEvent>& events) {
+	// Stable insertion sort by type, so events of one type keep the order they were gathered in. There are
+	// only ever a handful, and it doesn't allocate
+	for (size_t i = 1; i < events.size(); i++) {
+		ContactEvent ev = events[i];
+		size_t j = i;
+		for (; j > 0 && events[j - 1].type > ev.type; j--) events[j] = events[j - 1];
+		events[j] = ev;
+	}
+
+	ComponentArrays& c = sw.components();
+	for (size_t i = 0; i < events.size(); i++) {
+		Entity e = events[i].entity;
+		switch (events[i].type) {
+		case CONTACT_DAMAGE:
+			sw.attackPlayer();
+			events.resize(i + 1); // the player is dead, so nothing after this takes effect
+			return;
+		case CONTACT_FREEZE:
+			sw.freezePlayer();
+			c.freezeReadyTick[e.index] = sw.currentTick() + FREEZE_COOLDOWN_TICKS;
+			break;
+		default: // pickups and fleeing depend on the actor's type
+			c.actor[e.index]->onPlayerContact(events[i].type);
+			break;
+		}
+	}
+}
+
+bool pickupSystem(StudentWorld& sw, Entity e, int points) {
+	ComponentArrays& c = sw.components();
+	if (!(c.flags[e.index] & CAP_ALIVE)) return false;
+	sw.playSound(SOUND_GOT_GOODIE);
+	sw.increaseScore(points);
+	c.actor[e.index]->kill(); // goodie disappears
+	return true;
+}
+
+bool chaseSystem(StudentWorld& sw, Entity e) {
+	ComponentArrays& c = sw.components();
+	int x = c.x[e.index];
+	int y = c.y[e.index];
+	int nextX;
+	int nextY;
+	if (!sw.flowField().nextStep(x, y, nextX, nextY)) return false;
+	if (nextX != x) sw.setEntityDirection(e, nextX < x ? GraphObject::left : GraphObject::right);
+	sw.moveEntity(e, nextX, nextY);
+	return true;
+}
+
+void BarrelBatch::reserve(size_t n) {
+	entities.reserve(n);
+	x.reserve(n);
+	y.reserve(n);
+	direction.reserve(n);
+	ticks.reserve(n);
+}
+
+void BarrelBatch::clear() {
+	entities.clear();
+	x.clear();
+	y.clear();
+	direction.clear();
+	ticks.clear();
+}
+
+void BarrelBatch::add(Entity e, int xx, int yy, int dir, int nTicks) {
+	entities.push_back(e);
+	x.push_back(xx);
+	y.push_back(yy);
+	direction.push_back(dir);
+	ticks.push_back(nTicks);
+}
+
+void barrelPhysicsScalar(const unsigned int passableRows[], BarrelBatch& batch, size_t first, size_t last) {
+	// Mirrors Barrel::doSomething(). Barrels only ever stand on squares with x > 0 and y > 0, so every lookup stays on the board
+	for (size_t i = first; i < last; i++) {
+		int xx = batch.x[i];
+		int yy = batch.y[i];
+		int dir = batch.direction[i];
+		int t = (batch.ticks[i] + 1) % MAX_MOD_FACTOR;
+		if (passableBit(passableRows, xx, yy - 1)) { // fall under gravity
+			yy--;
+			if (!passableBit(passableRows, xx, yy - 1)) dir = flipDirection(dir); // reverse direction upon landing on the ground
+		}
+		if (s_tickTable.onTick[t]) {
+			int nx = xx + (dir == GraphObject::left ? -1 : 1);
+			if (passableBit(passableRows, nx, yy)) xx = nx;
+			else dir = flipDirection(dir); // bounce off the wall
+		}
+		batch.x[i] = xx;
+		batch.y[i] = yy;
+		batch.direction[i] = dir;
+		batch.ticks[i] = t;
+	}
+}
+
+void barrelPhysicsBatch(const unsigned int passableRows[], BarrelBatch& batch, size_t first, size_t last) {
+	size_t i = first;
+#if defined(__AVX2__)
+#if defined(_DEBUG)
+	BarrelBatch reference; // debug builds check the vector lanes against the scalar path; wonkykong_headless -d checks whole games in any build. Only this range is copied, since other threads may be writing the rest
+	for (size_t k = first; k < last; k++) reference.add(batch.entities[k], batch.x[k], batch.y[k], batch.direction[k], batch.ticks[k]);
+	barrelPhysicsScalar(passableRows, reference, 0, reference.size());
+#endif
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i wrap = _mm256_set1_epi32(MAX_MOD_FACTOR);
+	const __m256i leftDir = _mm256_set1_epi32(GraphObject::left);
+	const __m256i flipSum = _mm256_set1_epi32(GraphObject::left + GraphObject::right);
+	const int* rows = reinterpret_cast<const int*>(passableRows);
+	for (; i + 8 <= last; i += 8) {
+		__m256i xx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.x[i]));
+		__m256i yy = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.y[i]));
+		__m256i dir = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.direction[i]));
+		__m256i t = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.ticks[i])), one);
+		t = _mm256_andnot_si256(_mm256_cmpeq_epi32(t, wrap), t); // ticks are below MAX_MOD_FACTOR, so the wrap is a compare
+
+		// gravity: bit xx of the row below
+		__m256i below = _mm256_sub_epi32(yy, one);
+		__m256i fall = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srlv_epi32(_mm256_i32gather_epi32(rows, below, 4), xx), one), one);
+		yy = _mm256_add_epi32(yy, fall); // fall is -1 in lanes that drop a square
+		below = _mm256_sub_epi32(yy, one);
+		__m256i grounded = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srlv_epi32(_mm256_i32gather_epi32(rows, below, 4), xx), one), _mm256_setzero_si256());
+		dir = _mm256_blendv_epi8(dir, _mm256_sub_epi32(flipSum, dir), _mm256_and_si256(fall, grounded));
+
+		// lateral roll once every TICK_FACTOR ticks
+		__m256i onTick = _mm256_i32gather_epi32(s_tickTable.onTick, t, 4);
+		__m256i nx = _mm256_add_epi32(xx, _mm256_or_si256(_mm256_cmpeq_epi32(dir, leftDir), one)); // -1 when facing left, +1 otherwise
+		__m256i open = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srlv_epi32(_mm256_i32gather_epi32(rows, yy, 4), nx), one), one);
+		xx = _mm256_blendv_epi8(xx, nx, _mm256_and_si256(onTick, open));
+		dir = _mm256_blendv_epi8(dir, _mm256_sub_epi32(flipSum, dir), _mm256_andnot_si256(open, onTick));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.x[i]), xx);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.y[i]), yy);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.direction[i]), dir);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.ticks[i]), t);
+	}
+#endif
+	barrelPhysicsScalar(passableRows, batch, i, last); // the lanes left over, or every barrel without AVX2
+#if defined(__AVX2__) && defined(_DEBUG)
+	for (size_t k = first; k < last; k++) {
+		size_t r = k - first;
+		assert(batch.x[k] == reference.x[r] && batch.y[k] == reference.y[r] && batch.direction[k] == reference.direction[r] && batch.ticks[k] == reference.ticks[r]);
+	}
+#endif
+}
@@ -0,0 +1,47 @@
+#ifndef SYSTEMS_H_
+#define SYSTEMS_H_
+
+#include "Components.h"
+#include <vector>
+#include <cstddef>
+
+class StudentWorld;
+
+// Behaviour shared between actor types, written against the component arrays in StudentWorld rather than
+// Actor members. Each system handles one entity and works out what to do from its capability flags.
+// Actor subclasses still decide when each system runs by composing them in doSomething(), which keeps the
+// update order (and so gameplay) exactly as it was. Moving a type over fully means calling its systems in a
+// loop over its typed list instead of calling its doSomething(). Contact with the player is the exception:
+// StudentWorld gathers it for every entity at once after the update phase, and contactSystem() resolves it.
+bool unsupported(const StudentWorld& sw, Entity e); // true if nothing holds e up, so gravitySystem() would drop it
+bool gravitySystem(StudentWorld& sw, Entity e); // drops e one square if nothing holds it up. Returns true if it fell
+void patrolSystem(StudentWorld& sw, Entity e); // steps e along its direction, turning around at walls (and at cliffs, for CAP_AVOIDS_CLIFFS)
+bool climbSystem(StudentWorld& sw, Entity e); // keeps e climbing, or randomly starts it climbing, a ladder. Returns true if it moved
+void contactSystem(StudentWorld& sw, std::vector<ContactEvent>& events); // applies a tick's contact events in CONTACT_* order. Drops the ones that never took effect
+bool pickupSystem(StudentWorld& sw, Entity e, int points); // awards points and kills e, after a CONTACT_PICKUP. Returns false if it was already gone
+bool chaseSystem(StudentWorld& sw, Entity e); // moves e one step towards the player along the flow field, facing the way it walks. Returns false if there is no path
+
+// Packed copy of the live barrels' components, so barrel physics can run over all of them at once
+struct BarrelBatch {
+	std::vector<Entity> entities;
+	std::vector<int> x;
+	std::vector<int> y;
+	std::vector<int> direction;
+	std::vector<int> ticks;
+
+	size_t size() const { return entities.size(); }
+	void reserve(size_t n);
+	void clear();
+	void add(Entity e, int xx, int yy, int dir, int nTicks);
+};
+
+// One tick of barrel physics for barrels first to last - 1 of the batch: advance the tick phase, fall one
+// square if unsupported (turning around on landing) and, once every TICK_FACTOR ticks, roll one square or
+// bounce off a wall. Bit i of passableRows[y] is set if square (i, y) passes checkPassable(). Player contact
+// is left to the contact phase. Each barrel only reads the terrain and writes its own entries, so disjoint
+// ranges can run on different threads. Runs 8 barrels per instruction when built with AVX2, with the rest
+// done by barrelPhysicsScalar(), which gives bit-identical results
+void barrelPhysicsBatch(const unsigned int passableRows[], BarrelBatch& batch, size_t first, size_t last);
+void barrelPhysicsScalar(const unsigned int passableRows[], BarrelBatch& batch, size_t first, size_t last);
+
+#endif // SYSTEMS_H_
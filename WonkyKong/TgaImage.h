@@ -0,0 +1,100 @@
+#ifndef TGAIMAGE_H_
+#define TGAIMAGE_H_
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+  // An uncompressed TGA file's pixels, decoded without any graphics library, so both SpriteManager's
+  // OpenGL textures and the software renderer start from the same data
+struct TgaImage
+{
+	int width;
+	int height;
+	int bytesPerPixel;  // 3 for BGR data, 4 for BGRA
+	std::vector<char> pixels;  // width * height pixels in the file's BGR(A) order, bottom row first as OpenGL expects
+
+	TgaImage() : width(0), height(0), bytesPerPixel(0) {}
+
+	  // Reads filename into this image. Reports what went wrong to cerr and returns false if it can't
+	bool load(const std::string& filename_tga)
+	{
+		std::ifstream tgaFile(filename_tga, std::ios::in|std::ios::binary);
+
+		if (!tgaFile) {
+	  		std::cerr << "***** Unable to open " << filename_tga << std::endl;
+			return false;
+		}
+
+		TGA_HEADER header;
+		tgaFile.read((char *)&header,sizeof(header));
+		unsigned char byteCount = static_cast<unsigned char>(header.pixel_depth) / 8;
+		const long imageSize = header.width_pixels * header.height_pixels * byteCount;
+
+		pixels.resize(imageSize);
+		tgaFile.seekg(18);
+		  // Read image data
+		tgaFile.read(pixels.data(), imageSize);
+		if (!tgaFile)
+		{
+			std::cerr << "***** Unable to read " << imageSize << " (imageSize) bytes from file "
+					  << filename_tga << std::endl;
+			return false;
+		}
+
+		  // image type either 2 (color) or 3 (greyscale)
+		if (header.color_map_type != 0 || (header.image_type != 2 && header.image_type != 3))
+		{
+			std::cerr << "***** Bad color_map_type or image type in "
+					  << filename_tga << std::endl;
+			return false;
+		}
+
+		if (byteCount != 3 && byteCount != 4)
+		{
+			std::cerr << "***** Bad byte count " << byteCount << " in "
+					  << filename_tga << std::endl;
+			return false;
+		}
+
+		if (header.image_descriptor & 0x20)  // image ios flipped vertically
+	  		flipVertical(pixels.data(),header.width_pixels,header.height_pixels,byteCount);
+
+		width = header.width_pixels;
+		height = header.height_pixels;
+		bytesPerPixel = byteCount;
+		return true;
+	}
+
+private:
+
+#pragma pack(1)
+  struct TGA_HEADER {
+	unsigned char id_length;
+	unsigned char color_map_type;
+	unsigned char image_type;
+	unsigned short index_of_first_color_map_entry;
+	unsigned short color_map_length;
+	unsigned char color_map_entry_size;
+	unsigned short x_origin;
+	unsigned short y_origin;
+	unsigned short width_pixels;
+	unsigned short height_pixels;
+	unsigned char pixel_depth;
+	unsigned char image_descriptor; // bits 3-0 give alpha channel depth, and 5-4 give direction.
+  };
+#pragma pack()
+
+	static void flipVertical(char* image, int width, int height, int bytes_per_pixel)
+	{
+		int bytes_per_row = width * bytes_per_pixel;
+		for (int i = 0; i < height/2; i++)
+			std::swap_ranges(image + i * bytes_per_row,
+			                 image + (i+1) * bytes_per_row,
+							 image + (height-i-1) * bytes_per_row);
+	}
+};
+
+#endif // TGAIMAGE_H_
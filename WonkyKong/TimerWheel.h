@@ -0,0 +1,107 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include "Components.h"
+#include <vector>
+#include <cstddef>
+
+// Hierarchical timer wheel that wakes entities on a chosen future tick, so an actor that only acts every few
+// ticks costs nothing on the ticks in between. Level 0 has a slot for each of the next SLOTS ticks, and each
+// level above has slots SLOTS times as wide as the one below. A timer is filed in the lowest level whose span
+// still reaches its tick, and moves down a level (cascades) once the wheel gets there. Scheduling a timer
+// and expiring it are both constant time, however many timers are pending.
+class TimerWheel {
+public:
+	struct Timer {
+		Entity entity;
+		int delay; // ticks from scheduling to expiry
+		unsigned int due; // tick the timer expires on
+		unsigned int sequence; // schedule order, so timers due on the same tick expire in the order they were set
+	};
+	static const int SLOT_BITS = 6;
+	static const int SLOTS = 1 << SLOT_BITS;
+	static const int LEVELS = 3;
+	static const int MAX_DELAY = (SLOTS - 1) << (SLOT_BITS * (LEVELS - 1)); // longer delays are clamped to this
+	static const int SLOT_CAPACITY = 8; // timers each slot has room for before it allocates
+
+	TimerWheel();
+	void clear(); // drops every timer and goes back to tick 0. Slots keep their capacity
+	void schedule(Entity e, int delay); // wakes e delay ticks after the current one. delay is at least 1
+	void advance(std::vector<Timer>& expired); // moves on one tick and fills expired with the timers due on it, in schedule order
+	unsigned int now() const { return m_now; }
+	size_t pending() const { return m_pending; } // timers scheduled but not yet expired
+private:
+	std::vector<Timer> m_slots[LEVELS][SLOTS];
+	unsigned int m_now;
+	unsigned int m_sequence;
+	size_t m_pending;
+	void file(const Timer& t); // puts t in the slot matching how far off it is
+	void cascade(int level); // refiles the timers in level's current slot, now that the wheel has reached it
+};
+
+inline TimerWheel::TimerWheel() : m_now(0), m_sequence(0), m_pending(0) {
+	// Room up front, so a level's worth of actors doesn't have to grow the slots one by one mid-game. A
+	// timer that crosses a level 0 span goes through level 1, so that level needs it as much as level 0
+	for (int l = 0; l < LEVELS; l++) {
+		for (int s = 0; s < SLOTS; s++) m_slots[l][s].reserve(SLOT_CAPACITY);
+	}
+}
+
+inline void TimerWheel::clear() {
+	for (int l = 0; l < LEVELS; l++) {
+		for (int s = 0; s < SLOTS; s++) m_slots[l][s].clear();
+	}
+	m_now = 0;
+	m_sequence = 0;
+	m_pending = 0;
+}
+
+inline void TimerWheel::schedule(Entity e, int delay) {
+	if (delay < 1) delay = 1;
+	if (delay > MAX_DELAY) delay = MAX_DELAY;
+	Timer t = { e, delay, m_now + delay, m_sequence++ };
+	file(t);
+	m_pending++;
+}
+
+inline void TimerWheel::advance(std::vector<Timer>& expired) {
+	m_now++;
+	if ((m_now & (SLOTS - 1)) == 0) { // crossed into a new level 0 span, so bring its timers down, highest level first
+		for (int l = LEVELS - 1; l > 0; l--) {
+			if ((m_now & ((1u << (SLOT_BITS * l)) - 1)) == 0) cascade(l);
+		}
+	}
+
+	std::vector<Timer>& slot = m_slots[0][m_now & (SLOTS - 1)];
+	expired.assign(slot.begin(), slot.end());
+	slot.clear();
+	m_pending -= expired.size();
+
+	// Cascaded timers land behind ones filed straight into level 0, so restore schedule order. The slot is
+	// nearly sorted already, which insertion sort handles in a single pass without allocating
+	for (size_t i = 1; i < expired.size(); i++) {
+		Timer t = expired[i];
+		size_t j = i;
+		for (; j > 0 && expired[j - 1].sequence > t.sequence; j--) expired[j] = expired[j - 1];
+		expired[j] = t;
+	}
+}
+
+inline void TimerWheel::file(const Timer& t) {
+	for (int l = 0; l < LEVELS - 1; l++) {
+		int shift = SLOT_BITS * (l + 1);
+		if ((t.due >> shift) == (m_now >> shift)) { // due before this level's span rolls over
+			m_slots[l][(t.due >> (SLOT_BITS * l)) & (SLOTS - 1)].push_back(t);
+			return;
+		}
+	}
+	m_slots[LEVELS - 1][(t.due >> (SLOT_BITS * (LEVELS - 1))) & (SLOTS - 1)].push_back(t);
+}
+
+inline void TimerWheel::cascade(int level) {
+	std::vector<Timer>& slot = m_slots[level][(m_now >> (SLOT_BITS * level)) & (SLOTS - 1)];
+	for (size_t i = 0; i < slot.size(); i++) file(slot[i]); // always lands in a lower level, never back in slot
+	slot.clear();
+}
+
+#endif // TIMERWHEEL_H_
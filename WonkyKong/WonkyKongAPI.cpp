@@ -0,0 +1,193 @@
+#include "WonkyKongAPI.h"
+#include "WorldBatch.h"
+#include "StudentWorld.h"
+#include "GraphObject.h"
+#include "ObservationEncoder.h"
+#include "SoftwareRenderer.h"
+#include "GameConstants.h"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+struct wk_env {
+	wk_env(const string& assetPath, int nEnvs, int nThreads, uint64_t seed, int level)
+		: assetPath(assetPath), batch(assetPath, nEnvs, nThreads, seed, level), keys(nEnvs), encoders(nEnvs), resetDone(false), spritesLoaded(false), renderers(nEnvs) {}
+	string assetPath;
+	WorldBatch batch;
+	vector<int> keys; // the step's actions as KEY_PRESS_* codes. Sized once, so wk_step() doesn't allocate
+	vector<ObservationEncoder> encoders; // one per world, remembering what it last wrote for incremental encoding
+	bool resetDone; // set once wk_reset() has built every world. Until then batch.world() has nothing to return
+	SpriteSheet sprites; // read on the first wk_render()
+	bool spritesLoaded;
+	vector<unique_ptr<SoftwareRenderer>> renderers; // one per world, rebuilt when a call asks for another size, format or filter
+};
+
+static_assert(WK_NUM_PLANES == NUM_OBS_PLANES && WK_PLANE_KONG == OBS_PLANE_KONG && WK_PLANE_FLOOR == OBS_PLANE_FLOOR, "WK_PLANE_* must match OBS_PLANE_*");
+static_assert(WK_NUM_SCALARS == NUM_OBS_SCALARS && WK_SCALAR_JUMP == OBS_SCALAR_JUMP, "WK_SCALAR_* must match OBS_SCALAR_*");
+static_assert(WK_LAYOUT_NCHW == OBS_LAYOUT_NCHW && WK_LAYOUT_NHWC == OBS_LAYOUT_NHWC, "WK_LAYOUT_* must match OBS_LAYOUT_*");
+static_assert(WK_PIXELS_GREY == PIXELS_GREY && WK_PIXELS_RGBA == PIXELS_RGBA, "WK_PIXELS_* must match PIXELS_*");
+static_assert(WK_FILTER_NEAREST == FILTER_NEAREST && WK_FILTER_BILINEAR == FILTER_BILINEAR, "WK_FILTER_* must match FILTER_*");
+
+static const int MAX_FRAME_SIDE = 2048;
+
+static const int actionKeys[WK_NUM_ACTIONS] = { // by WK_ACTION_*
+	INVALID_KEY, KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN, KEY_PRESS_SPACE, KEY_PRESS_TAB
+};
+
+static const uint8_t imageCells[] = { // by IID_*
+	WK_CELL_PLAYER, WK_CELL_KONG, WK_CELL_BARREL, WK_CELL_FIREBALL, WK_CELL_KOOPA, WK_CELL_FLOOR, WK_CELL_LADDER,
+	WK_CELL_EXTRA_LIFE, WK_CELL_GARLIC, WK_CELL_BONFIRE, WK_CELL_BURP, WK_CELL_HUNTER
+};
+
+static uint8_t cellOf(int imageID) {
+	if (imageID < 0 || imageID >= static_cast<int>(sizeof(imageCells))) return WK_CELL_EMPTY;
+	return imageCells[imageID];
+}
+
+// What the renderer would draw, one byte per square: the terrain, then every visible object over it,
+// with the higher WK_CELL_* value winning where several share a square
+static void observe(const StudentWorld& sw, uint8_t* obs) {
+	for (int yy = 0; yy < VIEW_HEIGHT; yy++) {
+		uint8_t* row = obs + (VIEW_HEIGHT - 1 - yy) * VIEW_WIDTH;
+		for (int xx = 0; xx < VIEW_WIDTH; xx++) row[xx] = cellOf(sw.getTileImageID(xx, yy));
+	}
+	const vector<GraphObject*>& objects = sw.graphObjects();
+	for (size_t i = 0; i < objects.size(); i++) {
+		const GraphObject* go = objects[i];
+		int xx = go->getX();
+		int yy = go->getY();
+		if (!go->isVisible() || xx < 0 || yy < 0 || xx >= VIEW_WIDTH || yy >= VIEW_HEIGHT) continue;
+		uint8_t& cell = obs[(VIEW_HEIGHT - 1 - yy) * VIEW_WIDTH + xx];
+		uint8_t c = cellOf(go->getImageID());
+		if (c > cell) cell = c;
+	}
+}
+
+template <typename T>
+static int encodeAll(wk_env* env, int layout, T* out, int incremental) {
+	if (env == nullptr || !env->resetDone || out == nullptr || (layout != WK_LAYOUT_NCHW && layout != WK_LAYOUT_NHWC)) return WK_ERROR_ARGUMENT;
+	for (int i = 0; i < env->batch.size(); i++) {
+		T* world = out + static_cast<size_t>(i) * OBS_SIZE;
+		if (incremental) env->encoders[i].update(env->batch.world(i), layout, world);
+		else env->encoders[i].encode(env->batch.world(i), layout, world);
+	}
+	return WK_OK;
+}
+
+int wk_api_version(void) {
+	return WK_API_VERSION;
+}
+
+wk_env* wk_create(const char* asset_dir, int n_envs, int n_threads, uint64_t seed, int level) {
+	if (asset_dir == nullptr || n_envs < 1 || n_threads < 1 || level < 0 || level > 99) return nullptr;
+	string assetPath = asset_dir;
+	if (!assetPath.empty()) assetPath += '/';
+	string levelFile = "level";
+	levelFile += static_cast<char>('0' + level / 10);
+	levelFile += static_cast<char>('0' + level % 10);
+	levelFile += ".txt";
+	if (!ifstream(assetPath + levelFile)) return nullptr;
+	try {
+		return new wk_env(assetPath, n_envs, n_threads, seed, level);
+	}
+	catch (...) { // nothing may unwind into C
+		return nullptr;
+	}
+}
+
+void wk_destroy(wk_env* env) {
+	delete env;
+}
+
+int wk_num_envs(const wk_env* env) {
+	return env == nullptr ? 0 : env->batch.size();
+}
+
+int wk_obs_width(void) {
+	return VIEW_WIDTH;
+}
+
+int wk_obs_height(void) {
+	return VIEW_HEIGHT;
+}
+
+int wk_obs_size(void) {
+	return VIEW_WIDTH * VIEW_HEIGHT;
+}
+
+int wk_reset(wk_env* env, uint8_t* obs) {
+	if (env == nullptr) return WK_ERROR_ARGUMENT;
+	try {
+		env->resetDone = false; // a level that fails to load leaves its world without a player
+		if (!env->batch.reset()) return WK_ERROR_LEVEL;
+		env->resetDone = true;
+	}
+	catch (...) {
+		return WK_ERROR_INTERNAL;
+	}
+	return obs == nullptr ? WK_OK : wk_observe(env, obs);
+}
+
+int wk_step(wk_env* env, const int32_t* actions, int n_envs, uint8_t* obs, float* rewards, uint8_t* dones) {
+	if (env == nullptr || !env->resetDone || actions == nullptr || n_envs != env->batch.size()) return WK_ERROR_ARGUMENT;
+	for (int i = 0; i < n_envs; i++) env->keys[i] = (actions[i] >= 0 && actions[i] < WK_NUM_ACTIONS) ? actionKeys[actions[i]] : INVALID_KEY;
+	WorldBatch& batch = env->batch;
+	auto report = [&batch, obs, rewards, dones](int i) { // runs on the thread that stepped world i, so the observations are written in parallel too
+		const WorldStep& result = batch.result(i);
+		if (obs != nullptr) observe(batch.world(i), obs + static_cast<size_t>(i) * VIEW_WIDTH * VIEW_HEIGHT);
+		if (rewards != nullptr) rewards[i] = static_cast<float>(result.reward);
+		if (dones != nullptr) dones[i] = result.done ? 1 : 0;
+	};
+	try {
+		if (!batch.step(env->keys.data(), report)) return WK_ERROR_LEVEL;
+	}
+	catch (...) {
+		return WK_ERROR_INTERNAL;
+	}
+	return WK_OK;
+}
+
+int wk_observe(const wk_env* env, uint8_t* obs) {
+	if (env == nullptr || !env->resetDone || obs == nullptr) return WK_ERROR_ARGUMENT;
+	for (int i = 0; i < env->batch.size(); i++) observe(env->batch.world(i), obs + static_cast<size_t>(i) * VIEW_WIDTH * VIEW_HEIGHT);
+	return WK_OK;
+}
+
+int wk_tensor_size(void) {
+	return static_cast<int>(OBS_SIZE);
+}
+
+int wk_encode_u8(wk_env* env, int layout, uint8_t* out, int incremental) {
+	return encodeAll(env, layout, out, incremental);
+}
+
+int wk_encode_f32(wk_env* env, int layout, float* out, int incremental) {
+	return encodeAll(env, layout, out, incremental);
+}
+
+int wk_render(wk_env* env, int width, int height, int channels, int filter, uint8_t* out) {
+	if (env == nullptr || !env->resetDone || out == nullptr || width < 1 || height < 1 || width > MAX_FRAME_SIDE || height > MAX_FRAME_SIDE) return WK_ERROR_ARGUMENT;
+	if ((channels != WK_PIXELS_GREY && channels != WK_PIXELS_RGBA) || (filter != WK_FILTER_NEAREST && filter != WK_FILTER_BILINEAR)) return WK_ERROR_ARGUMENT;
+	try {
+		if (!env->spritesLoaded) {
+			if (!env->sprites.load(env->assetPath)) return WK_ERROR_ASSET;
+			env->spritesLoaded = true;
+		}
+		for (size_t i = 0; i < env->renderers.size(); i++) { // built here rather than on the pool, since the sheet scales its sprites on the first renderer of a size
+			unique_ptr<SoftwareRenderer>& renderer = env->renderers[i];
+			if (renderer == nullptr || renderer->width() != width || renderer->height() != height || renderer->channels() != channels || renderer->filter() != filter)
+				renderer.reset(new SoftwareRenderer(env->sprites, width, height, channels, filter));
+		}
+		size_t frameSize = static_cast<size_t>(width) * height * channels;
+		auto draw = [env, out, frameSize](int i) {
+			env->renderers[i]->render(env->batch.world(i), out + static_cast<size_t>(i) * frameSize);
+		};
+		env->batch.forEachWorld(draw);
+	}
+	catch (...) {
+		return WK_ERROR_INTERNAL;
+	}
+	return WK_OK;
+}
@@ -0,0 +1,175 @@
+#ifndef WONKYKONGAPI_H_
+#define WONKYKONGAPI_H_
+
+/* C interface of libwonkykong, for driving batches of WonkyKong worlds from other languages.
+ *
+ * One wk_env holds n_envs independent worlds that are stepped together, so a trainer pays the cost of a
+ * foreign call once per batch rather than once per world. Every buffer is supplied by the caller and
+ * laid out world by world. The first wk_reset() reads every level and sizes each world's lists, pools
+ * and scratch space for the most actors a game can have in play: every level's starting actors, the
+ * goodies its enemies can drop, a few burps, and up to 256 live barrels, beyond which Kong holds his
+ * throw. Only the index of actors by square can still grow, the first time more than 4 actors share a
+ * square, so wk_step() stops allocating once each world has reached that high-water mark.
+ *
+ * A world's episode is one game. It goes on through lost lives and finished levels until the game is
+ * over or won; the step that ends it reports done, and the world has already started its next game, so
+ * the observation returned with done is the first of the new episode. The games a world plays depend
+ * only on the seed and the world's index, never on the thread count.
+ *
+ * The functions are not thread safe for the same wk_env. Separate wk_envs can be used from separate
+ * threads.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(WONKYKONG_BUILD_DLL)
+#    define WK_API __declspec(dllexport)
+#  else
+#    define WK_API __declspec(dllimport)
+#  endif
+#else
+#  define WK_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WK_API_VERSION 3
+
+typedef struct wk_env wk_env;
+
+/* Results. */
+enum {
+	WK_OK = 0,
+	WK_ERROR_ARGUMENT = -1, /* a null env or buffer, a batch size that doesn't match the env, or a call that needs the worlds before a wk_reset() has succeeded */
+	WK_ERROR_LEVEL = -2, /* a level file is missing or malformed */
+	WK_ERROR_INTERNAL = -3, /* out of memory, or another failure inside the library */
+	WK_ERROR_ASSET = -4 /* a sprite's TGA file is missing or malformed */
+};
+
+/* Actions, one per world per step. Each is the key the player acts on that tick. */
+enum {
+	WK_ACTION_NONE = 0,
+	WK_ACTION_LEFT,
+	WK_ACTION_RIGHT,
+	WK_ACTION_UP, /* climb */
+	WK_ACTION_DOWN,
+	WK_ACTION_JUMP,
+	WK_ACTION_BURP,
+	WK_NUM_ACTIONS
+};
+
+/* Observation cells. Each square shows the highest-valued thing on it. */
+enum {
+	WK_CELL_EMPTY = 0,
+	WK_CELL_FLOOR,
+	WK_CELL_LADDER,
+	WK_CELL_GARLIC,
+	WK_CELL_EXTRA_LIFE,
+	WK_CELL_BURP,
+	WK_CELL_KONG,
+	WK_CELL_BONFIRE,
+	WK_CELL_BARREL,
+	WK_CELL_KOOPA,
+	WK_CELL_FIREBALL,
+	WK_CELL_HUNTER,
+	WK_CELL_PLAYER,
+	WK_NUM_CELLS
+};
+
+WK_API int wk_api_version(void);
+
+/* Builds n_envs worlds that step on n_threads threads, and whose games start on level (0 for the first).
+ * asset_dir holds the level files. Returns NULL if an argument is out of range or asset_dir has no
+ * level files. The worlds themselves are built by wk_reset(), which must succeed before wk_step(),
+ * wk_observe(), wk_encode_u8(), wk_encode_f32() or wk_render() is called. */
+WK_API wk_env* wk_create(const char* asset_dir, int n_envs, int n_threads, uint64_t seed, int level);
+WK_API void wk_destroy(wk_env* env);
+WK_API int wk_num_envs(const wk_env* env);
+
+/* An observation is wk_obs_height() rows of wk_obs_width() WK_CELL_* bytes per world, top row first. */
+WK_API int wk_obs_width(void);
+WK_API int wk_obs_height(void);
+WK_API int wk_obs_size(void); /* bytes per world */
+
+/* Starts a new game in every world and writes the first observations to obs (n_envs * wk_obs_size()
+ * bytes), unless obs is NULL. Returns WK_ERROR_LEVEL if a level can't be loaded, after which the other
+ * calls return WK_ERROR_ARGUMENT until a wk_reset() succeeds. */
+WK_API int wk_reset(wk_env* env, uint8_t* obs);
+
+/* Moves every world one tick, world i acting on actions[i]. Then, for each world, writes its
+ * observation to obs, the score it gained to rewards and whether its episode ended to dones. n_envs
+ * must match wk_create(). Any of obs, rewards and dones may be NULL. An unknown action counts as
+ * WK_ACTION_NONE. Returns WK_ERROR_ARGUMENT before the first successful wk_reset(). */
+WK_API int wk_step(wk_env* env, const int32_t* actions, int n_envs, uint8_t* obs, float* rewards, uint8_t* dones);
+
+/* Writes every world's current observation to obs. Returns WK_ERROR_ARGUMENT before the first successful
+ * wk_reset(). */
+WK_API int wk_observe(const wk_env* env, uint8_t* obs);
+
+/* Tensor observations: WK_NUM_PLANES one-hot planes of wk_obs_height() x wk_obs_width() squares, a square
+ * being 1 in a plane if that kind of thing is on it, followed by WK_NUM_SCALARS scalar features. Rows run
+ * top row first. */
+enum {
+	WK_PLANE_FLOOR = 0,
+	WK_PLANE_LADDER,
+	WK_PLANE_PLAYER,
+	WK_PLANE_BARREL,
+	WK_PLANE_FIREBALL,
+	WK_PLANE_KOOPA,
+	WK_PLANE_HUNTER,
+	WK_PLANE_BONFIRE,
+	WK_PLANE_GARLIC,
+	WK_PLANE_EXTRA_LIFE,
+	WK_PLANE_BURP,
+	WK_PLANE_KONG,
+	WK_NUM_PLANES
+};
+
+enum {
+	WK_SCALAR_LIVES = 0,
+	WK_SCALAR_BURPS,
+	WK_SCALAR_FREEZE, /* ticks the player has left frozen */
+	WK_SCALAR_JUMP, /* substeps left in the player's jump */
+	WK_NUM_SCALARS
+};
+
+enum {
+	WK_LAYOUT_NCHW = 0, /* plane by plane */
+	WK_LAYOUT_NHWC /* square by square, each square's planes together */
+};
+
+WK_API int wk_tensor_size(void); /* elements per world, in either layout */
+
+/* Writes every world's tensor observation to out, n_envs * wk_tensor_size() elements, world by world.
+ * Scalars are raw counts, clamped to 255 as bytes. With incremental set, only the squares that changed
+ * since the last call are rewritten, so out must not have been changed in between. The env remembers one
+ * buffer, so a call with a different buffer, layout or element type than the last writes everything.
+ * Returns WK_ERROR_ARGUMENT before the first successful wk_reset(). */
+WK_API int wk_encode_u8(wk_env* env, int layout, uint8_t* out, int incremental);
+WK_API int wk_encode_f32(wk_env* env, int layout, float* out, int incremental);
+
+/* Pixel observations: each world drawn as the game window shows it, less the status line along the top. */
+enum {
+	WK_PIXELS_GREY = 1, /* one luma byte per pixel */
+	WK_PIXELS_RGBA = 4 /* R, G, B and A bytes per pixel, A always 255 */
+};
+
+enum {
+	WK_FILTER_NEAREST = 0, /* sharp, blocky sprites */
+	WK_FILTER_BILINEAR /* sprites averaged down and the board resampled smoothly, closer to the window */
+};
+
+/* Writes every world's frame to out, n_envs * height * width * channels bytes, world by world, rows top
+ * first. width and height run from 1 to 2048. The sprites are read from the asset directory on the first
+ * call, and each world keeps the terrain it last drew, so later frames redraw only what moved. Returns
+ * WK_ERROR_ASSET if a sprite can't be read, and WK_ERROR_ARGUMENT before the first successful wk_reset(). */
+WK_API int wk_render(wk_env* env, int width, int height, int channels, int filter, uint8_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WONKYKONGAPI_H_ */
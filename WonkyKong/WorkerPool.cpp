@@ -0,0 +1,134 @@
+#include "WorkerPool.h"
+
+const int IDLE_SPINS = 1000; // times an idle worker checks for the next job before sleeping. Jobs come every tick, and a short spin is cheaper than waking a sleeping thread
+
+WorkerPool::WorkerPool(int nThreads)
+	: m_workers(nThreads > 1 ? nThreads : 1), m_func(nullptr), m_context(nullptr), m_n(0), m_chunk(1), m_generation(0), m_working(0),
+	  m_stopping(false), m_jobNs(0) {
+	resetStats();
+	for (int i = 1; i < nThreads; i++) m_threads.push_back(std::thread(&WorkerPool::workerLoop, this, i));
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+		m_generation++; // wakes the workers as if for a job, and they see m_stopping
+	}
+	m_jobReady.notify_all();
+	for (size_t i = 0; i < m_threads.size(); i++) m_threads[i].join();
+}
+
+int WorkerPool::size() const {
+	return static_cast<int>(m_threads.size()) + 1;
+}
+
+const WorkerPool::WorkerStats& WorkerPool::stats(int worker) const {
+	return m_workers[worker].stats;
+}
+
+long long WorkerPool::jobNs() const {
+	return m_jobNs;
+}
+
+void WorkerPool::resetStats() {
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		m_workers[i].stats.chunks = 0;
+		m_workers[i].stats.steals = 0;
+		m_workers[i].stats.busyNs = 0;
+	}
+	m_jobNs = 0;
+}
+
+void WorkerPool::run(size_t n, size_t chunk, ChunkFunc func, void* context) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_func = func;
+		m_context = context;
+		m_n = n;
+		m_chunk = chunk;
+		// Worker w starts with the w-th contiguous share of the chunks, so with even chunks nobody steals and
+		// each worker sees the same data as on the last job
+		size_t nChunks = (n + chunk - 1) / chunk;
+		size_t nWorkers = m_workers.size();
+		for (size_t w = 0; w < nWorkers; w++) {
+			m_workers[w].deque.store(pack(static_cast<uint32_t>(nChunks * w / nWorkers), static_cast<uint32_t>(nChunks * (w + 1) / nWorkers)),
+				std::memory_order_relaxed);
+		}
+		m_working = static_cast<int>(m_threads.size());
+		m_jobStart = std::chrono::steady_clock::now();
+		m_generation++; // publishes the fields above to workers that are spinning rather than waiting on the lock
+	}
+	m_jobReady.notify_all();
+	runChunks(0);
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobDone.wait(lock, [this] { return m_working == 0; }); // every worker checks in, so none can still be reading this job when the next one is set up
+	m_jobNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_jobStart).count();
+}
+
+void WorkerPool::runChunks(int self) {
+	auto start = std::chrono::steady_clock::now();
+	WorkerStats& stats = m_workers[self].stats;
+	uint32_t chunk;
+	while (popChunk(self, chunk) || stealChunks(self, chunk)) {
+		size_t begin = chunk * m_chunk;
+		m_func(m_context, begin, begin + m_chunk < m_n ? begin + m_chunk : m_n);
+		stats.chunks++;
+	}
+	stats.busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool WorkerPool::popChunk(int self, uint32_t& chunk) {
+	std::atomic<uint64_t>& deque = m_workers[self].deque;
+	uint64_t range = deque.load(std::memory_order_acquire);
+	for (;;) {
+		uint32_t top = static_cast<uint32_t>(range >> 32);
+		uint32_t bottom = static_cast<uint32_t>(range);
+		if (top >= bottom) return false;
+		if (deque.compare_exchange_weak(range, pack(top, bottom - 1), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			chunk = bottom - 1;
+			return true;
+		}
+	}
+}
+
+bool WorkerPool::stealChunks(int self, uint32_t& chunk) {
+	// The whole deque is one word, so a compare-and-swap that succeeds acted on the deque as it is now,
+	// even if the word changed and changed back since it was read
+	int nWorkers = static_cast<int>(m_workers.size());
+	for (int i = 1; i < nWorkers; i++) {
+		int victim = (self + i) % nWorkers;
+		std::atomic<uint64_t>& deque = m_workers[victim].deque;
+		uint64_t range = deque.load(std::memory_order_acquire);
+		for (;;) {
+			uint32_t top = static_cast<uint32_t>(range >> 32);
+			uint32_t bottom = static_cast<uint32_t>(range);
+			if (top >= bottom) break;
+			uint32_t half = (bottom - top + 1) / 2;
+			if (deque.compare_exchange_weak(range, pack(top + half, bottom), std::memory_order_acq_rel, std::memory_order_acquire)) {
+				chunk = top;
+				// Our own deque is empty, and nobody else adds to it, so a plain store is enough
+				if (half > 1) m_workers[self].deque.store(pack(top + 1, top + half), std::memory_order_release);
+				m_workers[self].stats.steals++;
+				return true;
+			}
+		}
+	}
+	return false; // every deque was empty when we looked. Chunks a thief is moving will be run by that thief
+}
+
+void WorkerPool::workerLoop(int self) {
+	unsigned int seen = 0; // generation of the last job this worker took part in
+	for (;;) {
+		for (int spin = 0; spin < IDLE_SPINS && m_generation == seen; spin++) std::this_thread::yield();
+		if (m_generation == seen) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobReady.wait(lock, [this, seen] { return m_generation != seen; });
+		}
+		seen = m_generation;
+		if (m_stopping) return; // written before the generation that woke us, so it is visible here
+		runChunks(self);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_working == 0) m_jobDone.notify_one();
+	}
+}
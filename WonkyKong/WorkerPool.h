@@ -0,0 +1,85 @@
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed set of threads that split one job at a time into chunks. The calling thread works through chunks
+// too, so a pool of size n runs n chunks at once. Each worker starts a job with its own deque of chunks, a
+// contiguous share of the job, and runs them from the bottom. A worker whose deque runs dry steals the top
+// half of another's, so a few slow chunks (a world starting a new episode, say) don't leave the other
+// workers idle at the end of the job. Chunk k always covers the same range whoever runs it, so a job whose
+// chunks write disjoint results gives the same answer at every pool size.
+class WorkerPool {
+public:
+	struct WorkerStats { // what one worker did, summed over the jobs since the last resetStats()
+		long long chunks; // chunks it ran
+		long long steals; // times it took chunks from another worker's deque
+		long long busyNs; // time from joining a job until it found no chunks left anywhere
+	};
+
+	explicit WorkerPool(int nThreads); // starts nThreads - 1 threads. A pool of size 1 runs everything on the caller
+	~WorkerPool(); // stops and joins the threads
+	int size() const;
+	template <typename Func>
+	void parallelFor(size_t n, size_t chunk, Func& f); // calls f(begin, end) for each chunk of [0, n), and returns once every chunk is done
+	const WorkerStats& stats(int worker) const; // worker 0 is the calling thread. Only read between jobs
+	long long jobNs() const; // total time spent in parallelFor. A worker's busyNs over this is its utilisation
+	void resetStats();
+private:
+	typedef void (*ChunkFunc)(void* context, size_t begin, size_t end);
+	template <typename Func>
+	static void callChunk(void* context, size_t begin, size_t end) { (*static_cast<Func*>(context))(begin, end); }
+
+	struct alignas(64) Worker { // on its own cache line, since its deque is hit by every chunk its owner takes
+		std::atomic<uint64_t> deque; // chunks [top, bottom), top in the high half. Owner and thieves both change it with one compare-and-swap
+		WorkerStats stats;
+	};
+
+	static uint64_t pack(uint32_t top, uint32_t bottom) { return (static_cast<uint64_t>(top) << 32) | bottom; }
+	void run(size_t n, size_t chunk, ChunkFunc func, void* context); // publishes the job, helps with it, then waits for the rest
+	void runChunks(int self); // takes chunks of the current job, from self's deque and then by stealing, until none are left
+	bool popChunk(int self, uint32_t& chunk); // takes the bottom chunk of self's deque
+	bool stealChunks(int self, uint32_t& chunk); // moves the top half of another deque to self's, and takes the first of them
+	void workerLoop(int self);
+
+	std::vector<std::thread> m_threads;
+	std::vector<Worker> m_workers; // one per thread, plus the caller at index 0
+	std::mutex m_mutex;
+	std::condition_variable m_jobReady;
+	std::condition_variable m_jobDone;
+	ChunkFunc m_func; // current job. A function pointer and context rather than std::function, so publishing a job doesn't allocate
+	void* m_context;
+	size_t m_n;
+	size_t m_chunk;
+	std::atomic<unsigned int> m_generation; // bumped for every job, so spinning workers notice it without the lock
+	int m_working; // threads still inside the current job
+	bool m_stopping;
+	std::chrono::steady_clock::time_point m_jobStart;
+	long long m_jobNs;
+};
+
+template <typename Func>
+void WorkerPool::parallelFor(size_t n, size_t chunk, Func& f) {
+	if (n == 0) return;
+	if (chunk == 0) chunk = 1;
+	if (m_threads.empty() || n <= chunk) { // nothing to share out
+		auto start = std::chrono::steady_clock::now();
+		long long chunks = 0;
+		for (size_t begin = 0; begin < n; begin += chunk, chunks++) f(begin, begin + chunk < n ? begin + chunk : n);
+		long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		m_workers[0].stats.chunks += chunks;
+		m_workers[0].stats.busyNs += ns;
+		m_jobNs += ns;
+		return;
+	}
+	run(n, chunk, &callChunk<Func>, &f);
+}
+
+#endif // WORKERPOOL_H_
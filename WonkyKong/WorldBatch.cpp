@@ -0,0 +1,152 @@
+#include "WorldBatch.h"
+#include "StudentWorld.h"
+#include "GameConstants.h"
+#include <string>
+using namespace std;
+
+WorldBatch::WorldBatch(string assetPath, int nWorlds, int nThreads, uint64_t seed, int startLevel)
+	: m_assetPath(assetPath), m_slots(nWorlds > 0 ? nWorlds : 1),
+	  m_pool(nWorlds > 1 ? (nThreads < nWorlds ? nThreads : nWorlds) : 1), // a single world spends the threads on its own update instead
+	  m_updateThreads(nWorlds > 1 || nThreads < 1 ? 1 : nThreads), m_startLevel(startLevel > 0 ? startLevel : 0), m_diagnostics(false), m_failed(false) {
+	Random batchSeeds(seed);
+	for (size_t i = 0; i < m_slots.size(); i++) {
+		Slot& slot = m_slots[i];
+		slot.world = nullptr;
+		slot.seeds = batchSeeds.stream(i);
+		slot.last.reward = 0;
+		slot.last.status = GWSTATUS_CONTINUE_GAME;
+		slot.last.done = false;
+		slot.status = GWSTATUS_CONTINUE_GAME;
+		slot.episodes = 0;
+		slot.levels = 0;
+		slot.deaths = 0;
+	}
+}
+
+WorldBatch::~WorldBatch() {
+	for (size_t i = 0; i < m_slots.size(); i++) delete m_slots[i].world; // each world reports leaks to its own host, which is still alive
+}
+
+int WorldBatch::size() const {
+	return static_cast<int>(m_slots.size());
+}
+
+int WorldBatch::threads() const {
+	return m_pool.size() > m_updateThreads ? m_pool.size() : m_updateThreads;
+}
+
+bool WorldBatch::reset() {
+	auto resetOne = [this](int i) { newGame(m_slots[i]); };
+	runOnWorlds(resetOne);
+	for (size_t i = 0; i < m_slots.size(); i++) {
+		if (m_slots[i].status == GWSTATUS_LEVEL_ERROR) return false;
+	}
+	return true;
+}
+
+bool WorldBatch::step(const int* keys) {
+	auto nothing = [](int) {};
+	return step(keys, nothing);
+}
+
+void WorldBatch::setDiagnostics(bool on) {
+	m_diagnostics = on;
+	for (size_t i = 0; i < m_slots.size(); i++) {
+		if (m_slots[i].world != nullptr) m_slots[i].world->setDiagnostics(on);
+	}
+}
+
+const WorldStep& WorldBatch::result(int i) const {
+	return m_slots[i].last;
+}
+
+const WorkerPool& WorldBatch::workers() const {
+	return m_pool;
+}
+
+void WorldBatch::resetWorkerStats() {
+	m_pool.resetStats();
+}
+
+StudentWorld& WorldBatch::world(int i) {
+	return *m_slots[i].world;
+}
+
+const StudentWorld& WorldBatch::world(int i) const {
+	return *m_slots[i].world;
+}
+
+long long WorldBatch::episodes() const {
+	long long total = 0;
+	for (size_t i = 0; i < m_slots.size(); i++) total += m_slots[i].episodes;
+	return total;
+}
+
+long long WorldBatch::levelsFinished() const {
+	long long total = 0;
+	for (size_t i = 0; i < m_slots.size(); i++) total += m_slots[i].levels;
+	return total;
+}
+
+long long WorldBatch::deaths() const {
+	long long total = 0;
+	for (size_t i = 0; i < m_slots.size(); i++) total += m_slots[i].deaths;
+	return total;
+}
+
+long long WorldBatch::soundsPlayed() const {
+	long long total = 0;
+	for (size_t i = 0; i < m_slots.size(); i++) total += m_slots[i].host.soundsPlayed();
+	return total;
+}
+
+long long WorldBatch::graphObjectsLeaked() const {
+	long long total = 0;
+	for (size_t i = 0; i < m_slots.size(); i++) total += m_slots[i].host.graphObjectsLeaked();
+	return total;
+}
+
+void WorldBatch::stepWorld(Slot& slot, int key) {
+	if (slot.status == GWSTATUS_LEVEL_ERROR) return; // step() has already reported it
+	int scoreBefore = slot.world->getScore();
+	int status = slot.world->step(key);
+	slot.last.reward = slot.world->getScore() - scoreBefore;
+	slot.last.status = status;
+	slot.last.done = false;
+	// Same handling as GameController, without the prompts between lives and levels
+	if (status == GWSTATUS_PLAYER_DIED) {
+		slot.deaths++;
+		slot.world->cleanUp();
+		if (slot.world->isGameOver()) status = GWSTATUS_PLAYER_WON; // not won, but either way this game is over
+		else status = slot.world->init();
+	}
+	else if (status == GWSTATUS_FINISHED_LEVEL) {
+		slot.levels++;
+		slot.world->advanceToNextLevel();
+		slot.world->cleanUp();
+		status = slot.world->init(); // PLAYER_WON once there are no levels left
+	}
+	slot.status = status;
+	if (status == GWSTATUS_PLAYER_WON) {
+		slot.episodes++;
+		slot.last.done = true;
+		newGame(slot);
+	}
+}
+
+void WorldBatch::newGame(Slot& slot) {
+	if (slot.world == nullptr) {
+		slot.world = new StudentWorld(m_assetPath);
+		slot.world->setController(&slot.host);
+		slot.world->setUpdateThreads(m_updateThreads);
+	}
+	else {
+		if (slot.status == GWSTATUS_CONTINUE_GAME) slot.world->cleanUp(); // a reset() in the middle of a level. A finished game has already cleaned up
+		slot.world->resetGame();
+	}
+	slot.world->setDiagnostics(m_diagnostics);
+	slot.world->setSeed(slot.seeds.next());
+	for (int i = 0; i < m_startLevel; i++) slot.world->advanceToNextLevel();
+	slot.status = slot.world->init();
+	if (slot.status == GWSTATUS_PLAYER_WON) slot.status = GWSTATUS_LEVEL_ERROR; // a game won before it starts has no first level
+}
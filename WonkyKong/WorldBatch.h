@@ -0,0 +1,119 @@
+#ifndef WORLDBATCH_H_
+#define WORLDBATCH_H_
+
+#include "HeadlessHost.h"
+#include "Random.h"
+#include "WorkerPool.h"
+#include "GameConstants.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <cstdint>
+
+class StudentWorld;
+
+struct WorldStep { // what one world did on the last step()
+	int reward; // score gained this step
+	int status; // GWSTATUS_* that move() returned
+	bool done; // the episode ended this step, and the world has already started the next one
+};
+
+// N independent worlds stepped together on a fixed pool of threads, for running many episodes at once. Each
+// world has its own HeadlessHost, generator and graph objects, so no world touches another's state and the
+// worlds can move in parallel. An episode is one game: it goes on through lost lives and finished levels
+// until the game is over or won, and then a new game starts in its place with the next seed from that
+// world's own stream. The seeds each world plays therefore depend only on the batch seed and the world's
+// index, never on the thread count. Worlds are built once and replay game after game. The first reset()
+// builds them, and each reads every level and reserves room for all the actors a game can have in play, so
+// step() only allocates when more actors share a square than the world's index has yet held.
+class WorldBatch {
+public:
+	WorldBatch(std::string assetPath, int nWorlds, int nThreads, uint64_t seed, int startLevel = 0); // every game starts on startLevel
+	~WorldBatch();
+	int size() const; // worlds in the batch
+	int threads() const;
+	bool reset(); // starts a new game in every world. False if a level file is missing or malformed. Rethrows anything a world threw, as step() does
+	bool step(const int* keys); // moves world i one tick with keys[i] (or INVALID_KEY) as the player's input. False on a level error
+	template <typename Func>
+	bool step(const int* keys, Func& afterStep); // step(keys), calling afterStep(i) on the thread that stepped world i, once it has. If either throws for a world, the other worlds still step and the first exception is rethrown here
+	template <typename Func>
+	void forEachWorld(Func& f); // calls f(i) for every world, in parallel on the pool, as step() calls afterStep. Rethrows as step() does
+	void setDiagnostics(bool on); // whether the worlds report on each level to cerr. Off by default, since worlds on several threads would interleave their lines
+	const WorldStep& result(int i) const; // world i's last step
+	StudentWorld& world(int i);
+	const StudentWorld& world(int i) const;
+	const WorkerPool& workers() const; // the pool stepping the worlds, for its per-worker counters
+	void resetWorkerStats();
+	long long episodes() const; // games finished since construction
+	long long levelsFinished() const;
+	long long deaths() const;
+	long long soundsPlayed() const;
+	long long graphObjectsLeaked() const;
+private:
+	struct alignas(64) Slot { // one world and what it needs, kept to its own cache lines since each is written by whichever thread steps it
+		StudentWorld* world;
+		HeadlessHost host;
+		Random seeds; // seeds for this world's games
+		WorldStep last;
+		int status; // GWSTATUS_* from the last init() or move()
+		long long episodes;
+		long long levels;
+		long long deaths;
+	};
+
+	void stepWorld(Slot& slot, int key); // runs on a pool thread
+	void newGame(Slot& slot); // starts a new game in slot's world, building the world the first time
+	template <typename Func>
+	void runOnWorlds(Func& f); // calls f(i) for every world on the pool, one world per chunk, then rethrows the first exception any call threw
+
+	std::string m_assetPath;
+	std::vector<Slot> m_slots; // never resized, so the hosts the worlds point at stay put
+	WorkerPool m_pool;
+	int m_updateThreads; // threads each world updates its barrels on. More than 1 only for a batch of one world
+	int m_startLevel;
+	bool m_diagnostics;
+	std::atomic<bool> m_failed; // a world threw during the current job
+	std::exception_ptr m_error; // what it threw. Written only by the thread that set m_failed, and read once the job is done
+};
+
+template <typename Func>
+void WorldBatch::runOnWorlds(Func& f) {
+	// An exception must not leave a chunk: on a worker thread it would end the process, and on the calling
+	// thread it would unwind out of the job while the workers still run chunks that point at f. So each world
+	// catches its own, the job finishes, and the first one is rethrown once nothing refers to f any more
+	m_failed = false;
+	m_error = nullptr;
+	auto range = [this, &f](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			try {
+				f(static_cast<int>(i));
+			}
+			catch (...) {
+				if (!m_failed.exchange(true)) m_error = std::current_exception();
+			}
+		}
+	};
+	m_pool.parallelFor(m_slots.size(), 1, range); // one world per chunk. A world starting a new game takes far longer than one that just moves, and the pool's stealing evens that out only if those worlds are chunks of their own
+	if (m_failed) std::rethrow_exception(m_error);
+}
+
+template <typename Func>
+bool WorldBatch::step(const int* keys, Func& afterStep) {
+	auto stepOne = [this, keys, &afterStep](int i) {
+		stepWorld(m_slots[i], keys[i]);
+		afterStep(i);
+	};
+	runOnWorlds(stepOne);
+	for (size_t i = 0; i < m_slots.size(); i++) {
+		if (m_slots[i].status == GWSTATUS_LEVEL_ERROR) return false;
+	}
+	return true;
+}
+
+template <typename Func>
+void WorldBatch::forEachWorld(Func& f) {
+	runOnWorlds(f);
+}
+
+#endif // WORLDBATCH_H_